@@ -0,0 +1,177 @@
+#ifndef ARCFLAGS_HPP
+#define ARCFLAGS_HPP
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "compactgraph.hpp"
+#include "parallel.hpp"
+#include "partition.hpp"
+#include "search.hpp"
+
+/******************** ArcFlags ********************/
+
+/*
+ * Arc-flags acceleration for point-to-point queries on one weight column.
+ *
+ * The graph is split into regions by the built-in partitioner. Edge e gets the flag of region r
+ * when it lies on some shortest path into r: every edge inside r is flagged, and for each boundary
+ * vertex b of r (one with an edge coming from outside) a backward search from b flags every edge
+ * (u, v) with dist(u, b) == w(u, v) + dist(v, b). Ties are all flagged, so whatever shortest path
+ * reaches r through its last boundary vertex keeps all its edges. Queries towards a target in r
+ * skip every edge without the flag of r.
+ *
+ * Flags are stored per region, one bit per edge, so a region is recomputed (in parallel with the
+ * others, with one workspace per thread) without touching the rest. After weight changes only
+ * some regions need it: a weight increase matters only to the regions flagged on that edge, while
+ * a decrease can create new shortest paths into any region.
+ */
+template <class T>
+class ArcFlags {
+public:
+    ArcFlags(const CompactGraph<T>& graph, const std::vector<double>& weights, int regions);
+
+    int getRegionCount() const;
+    int getRegion(int v) const;
+    bool hasFlag(int e, int region) const;
+
+    // recomputes the flags of the given regions against the current weights
+    void update(const std::vector<int>& regions);
+    // edges whose weight changed, with their previous weight; updates the regions that need it
+    void edgesChanged(const std::vector<std::pair<int, double>>& changes);
+
+    // point-to-point search on flagged edges, same contract as shortestPath
+    template <class H>
+    double shortestPath(int source, int target, SearchWorkspace& ws, H heuristic) const;
+    double shortestPath(int source, int target, SearchWorkspace& ws) const;
+
+protected:
+    const CompactGraph<T>& graph;
+    const std::vector<double>& weights;
+    int regionCount;
+    std::vector<int> region;
+    std::vector<std::vector<int>> boundary;    // per region
+    std::vector<std::vector<uint64_t>> flags;  // per region, one bit per edge
+
+    void computeRegion(int r, SearchWorkspace& ws);
+};
+
+/************************* ArcFlags  **************************/
+
+template <class T>
+ArcFlags<T>::ArcFlags(const CompactGraph<T>& graph, const std::vector<double>& weights, int regions)
+    : graph(graph), weights(weights), regionCount(regions), region(partitionGraph(graph, regions)), boundary(regions),
+      flags(regions) {
+    for (int v = 0; v < graph.getNumVertex(); v++) {
+        for (int i = graph.inEdgesBegin(v); i < graph.inEdgesEnd(v); i++) {
+            if (region[graph.getTail(graph.getInEdge(i))] != region[v]) {
+                boundary[region[v]].push_back(v);
+                break;
+            }
+        }
+    }
+    std::vector<int> all(regions);
+    for (int r = 0; r < regions; r++) all[r] = r;
+    update(all);
+}
+
+template <class T>
+int ArcFlags<T>::getRegionCount() const {
+    return regionCount;
+}
+
+template <class T>
+int ArcFlags<T>::getRegion(int v) const {
+    return region[v];
+}
+
+template <class T>
+bool ArcFlags<T>::hasFlag(int e, int r) const {
+    return (flags[r][e >> 6] >> (e & 63)) & 1;
+}
+
+template <class T>
+void ArcFlags<T>::computeRegion(int r, SearchWorkspace& ws) {
+    int m = graph.getNumEdges();
+    std::vector<uint64_t>& own = flags[r];
+    own.assign((m + 63) / 64, 0);
+    auto set = [&](int e) { own[e >> 6] |= uint64_t(1) << (e & 63); };
+
+    for (int e = 0; e < m; e++) {
+        if (region[graph.getTail(e)] == r && region[graph.getHead(e)] == r) set(e);
+    }
+    for (int b : boundary[r]) {
+        shortestPathTree(graph, weights, b, ws, INF, true);
+        for (int u : ws.order) {
+            for (int e = graph.edgesBegin(u); e < graph.edgesEnd(u); e++) {
+                int v = graph.getHead(e);
+                if (weights[e] != INF && ws.settled[v] && ws.dist[v] + weights[e] == ws.dist[u]) set(e);
+            }
+        }
+    }
+}
+
+template <class T>
+void ArcFlags<T>::update(const std::vector<int>& regions) {
+    unsigned int threads = getThreadCount();
+    std::vector<SearchWorkspace> ws(threads);
+    parallelFor(regions.size(), [&](int i, unsigned int t) {
+        computeRegion(regions[i], ws[t]);
+    }, threads);
+}
+
+template <class T>
+void ArcFlags<T>::edgesChanged(const std::vector<std::pair<int, double>>& changes) {
+    std::vector<char> stale(regionCount, false);
+    for (const auto& [e, previous] : changes) {
+        for (int r = 0; r < regionCount; r++) {
+            if (weights[e] < previous || hasFlag(e, r)) stale[r] = true;
+        }
+    }
+    std::vector<int> regions;
+    for (int r = 0; r < regionCount; r++) {
+        if (stale[r]) regions.push_back(r);
+    }
+    update(regions);
+}
+
+template <class T>
+template <class H>
+double ArcFlags<T>::shortestPath(int source, int target, SearchWorkspace& ws, H heuristic) const {
+    ws.resize(graph.getNumVertex());
+    ws.reset();
+    const std::vector<uint64_t>& allowed = flags[region[target]];
+
+    SearchQueue pq; // keyed on distance + heuristic
+    ws.reach(source, 0, -1);
+    pq.push({heuristic(source), source});
+    while (!pq.empty()) {
+        int u = pq.top().second;
+        pq.pop();
+        if (ws.settled[u]) continue;
+        ws.settled[u] = true;
+        ws.order.push_back(u);
+        double d = ws.dist[u];
+        if (u == target) return d;
+
+        for (int e = graph.edgesBegin(u); e < graph.edgesEnd(u); e++) {
+            if (!((allowed[e >> 6] >> (e & 63)) & 1)) continue;
+            double w = weights[e];
+            if (w == INF) continue;
+            int v = graph.getHead(e);
+            if (ws.settled[v]) continue;
+            if (d + w < ws.dist[v]) {
+                ws.reach(v, d + w, e);
+                pq.push({d + w + heuristic(v), v});
+            }
+        }
+    }
+    return INF;
+}
+
+template <class T>
+double ArcFlags<T>::shortestPath(int source, int target, SearchWorkspace& ws) const {
+    return shortestPath(source, target, ws, [](int) { return 0.0; });
+}
+
+#endif
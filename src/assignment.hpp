@@ -0,0 +1,190 @@
+#ifndef ASSIGNMENT_HPP
+#define ASSIGNMENT_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "compactgraph.hpp"
+#include "parallel.hpp"
+#include "placement.hpp"
+#include "search.hpp"
+
+// weight column the equilibrium driving times are written to
+const std::string CONGESTED_PROFILE = "congested";
+
+struct AssignmentResult {
+    std::vector<double> flow;  // equilibrium volume per edge
+    std::vector<double> times; // congested travel time per edge (INF where the road cannot be driven)
+    int iterations = 0;
+    double relativeGap = 1;    // 1 - shortest-path cost / total cost, 0 at equilibrium
+    double totalTime = 0;      // sum of flow * time
+    int unassigned = 0;        // demand pairs without any route
+};
+
+/******************** TrafficAssignment ********************/
+
+/*
+ * Static user-equilibrium traffic assignment of an origin/destination demand, by
+ * Frank-Wolfe with an exact line search.
+ * Each edge costs t(v) = t0 * (1 + alpha * (v / c)^beta) (BPR), with t0 its free-flow driving
+ * time and c its capacity. Edges without a positive finite capacity are not congested.
+ *
+ * Every iteration:
+ *  - loads the demand all-or-nothing on the shortest paths for the current times. There is
+ *    one tree per distinct origin, built in parallel with one reusable workspace and volume
+ *    accumulator per thread. The volumes are pushed up each tree in reverse settle order,
+ *    so a tree is loaded in O(n) whatever its number of destinations.
+ *  - moves the flow towards that loading by the step that minimises the Beckmann objective.
+ *    Its derivative is monotone, so the step is found by bisection.
+ * Iterations stop when the relative gap drops below the tolerance.
+ */
+template <class T>
+class TrafficAssignment {
+public:
+    TrafficAssignment(const CompactGraph<T>& graph, const std::vector<double>& freeFlow,
+                      const std::vector<double>& capacity, double alpha = 0.15, double beta = 4);
+
+    AssignmentResult assign(const std::vector<Demand>& demand, int maxIterations = 50, double tolerance = 1e-4);
+
+    double time(int e, double volume) const;
+
+protected:
+    const CompactGraph<T>& graph;
+    const std::vector<double>& freeFlow;
+    const std::vector<double>& capacity;
+    double alpha, beta;
+
+    std::vector<int> origins;
+    std::vector<std::vector<std::pair<int, double>>> tripsFrom; // (destination, volume) per origin
+    std::vector<SearchWorkspace> ws;
+    std::vector<std::vector<double>> load, volume; // per thread
+
+    // all-or-nothing loading for the given times; returns the number of pairs without a route
+    int allOrNothing(const std::vector<double>& times, std::vector<double>& target);
+};
+
+/************************* TrafficAssignment  **************************/
+
+template <class T>
+TrafficAssignment<T>::TrafficAssignment(const CompactGraph<T>& graph, const std::vector<double>& freeFlow,
+                                        const std::vector<double>& capacity, double alpha, double beta)
+    : graph(graph), freeFlow(freeFlow), capacity(capacity), alpha(alpha), beta(beta) {}
+
+template <class T>
+double TrafficAssignment<T>::time(int e, double volume) const {
+    double c = capacity[e];
+    if (freeFlow[e] == INF || c <= 0 || c == INF) return freeFlow[e];
+    return freeFlow[e] * (1 + alpha * std::pow(volume / c, beta));
+}
+
+template <class T>
+int TrafficAssignment<T>::allOrNothing(const std::vector<double>& times, std::vector<double>& target) {
+    int m = graph.getNumEdges();
+    unsigned int threads = ws.size();
+    for (std::vector<double>& v : volume) std::fill(v.begin(), v.end(), 0);
+    std::vector<int> missing(threads, 0);
+
+    parallelFor(origins.size(), [&](int o, unsigned int t) {
+        SearchWorkspace& own = ws[t];
+        std::vector<double>& pending = load[t];
+        shortestPathTree(graph, times, origins[o], own);
+        for (const auto& [d, trips] : tripsFrom[o]) {
+            if (own.dist[d] == INF) missing[t]++;
+            else pending[d] += trips;
+        }
+        for (auto it = own.order.rbegin(); it != own.order.rend(); ++it) {
+            int v = *it;
+            int e = own.parent[v];
+            if (pending[v] == 0) continue;
+            if (e != -1) {
+                volume[t][e] += pending[v];
+                pending[graph.getTail(e)] += pending[v];
+            }
+            pending[v] = 0;
+        }
+    }, threads);
+
+    std::fill(target.begin(), target.end(), 0);
+    int unassigned = 0;
+    for (unsigned int t = 0; t < threads; t++) {
+        for (int e = 0; e < m; e++) target[e] += volume[t][e];
+        unassigned += missing[t];
+    }
+    return unassigned;
+}
+
+template <class T>
+AssignmentResult TrafficAssignment<T>::assign(const std::vector<Demand>& demand, int maxIterations, double tolerance) {
+    int n = graph.getNumVertex(), m = graph.getNumEdges();
+    unsigned int threads = getThreadCount();
+    ws.resize(threads);
+    load.assign(threads, std::vector<double>(n, 0));
+    volume.assign(threads, std::vector<double>(m, 0));
+
+    origins.clear();
+    tripsFrom.clear();
+    std::unordered_map<int, int> originIndex;
+    for (const Demand& trip : demand) {
+        if (trip.origin == trip.destination) continue;
+        if (originIndex.insert({trip.origin, static_cast<int>(origins.size())}).second) {
+            origins.push_back(trip.origin);
+            tripsFrom.push_back({});
+        }
+        tripsFrom[originIndex[trip.origin]].push_back({trip.destination, trip.weight});
+    }
+
+    AssignmentResult result;
+    std::vector<double>& flow = result.flow;
+    std::vector<double>& times = result.times;
+    flow.assign(m, 0);
+    times = freeFlow;
+    std::vector<double> target(m, 0);
+    result.unassigned = allOrNothing(times, flow);
+
+    while (result.iterations < maxIterations) {
+        result.iterations++;
+        for (int e = 0; e < m; e++) times[e] = time(e, flow[e]);
+        allOrNothing(times, target);
+
+        double current = 0, best = 0;
+        for (int e = 0; e < m; e++) {
+            if (times[e] == INF) continue;
+            current += times[e] * flow[e];
+            best += times[e] * target[e];
+        }
+        result.relativeGap = current > 0 ? (current - best) / current : 0;
+        if (result.relativeGap < tolerance) break;
+
+        // derivative of the objective along flow + step * (target - flow), increasing in step
+        auto slope = [&](double step) {
+            double total = 0;
+            for (int e = 0; e < m; e++) {
+                double direction = target[e] - flow[e];
+                if (direction != 0) total += direction * time(e, flow[e] + step * direction);
+            }
+            return total;
+        };
+        double step = 1;
+        if (slope(1) > 0) {
+            double low = 0, high = 1;
+            for (int i = 0; i < 40; i++) {
+                double middle = (low + high) / 2;
+                if (slope(middle) > 0) high = middle;
+                else low = middle;
+            }
+            step = (low + high) / 2;
+        }
+        for (int e = 0; e < m; e++) flow[e] += step * (target[e] - flow[e]);
+    }
+
+    result.totalTime = 0;
+    for (int e = 0; e < m; e++) {
+        times[e] = time(e, flow[e]);
+        if (times[e] != INF) result.totalTime += times[e] * flow[e];
+    }
+    return result;
+}
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef BETWEENNESS_HPP
+#define BETWEENNESS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "compactgraph.hpp"
+#include "parallel.hpp"
+#include "search.hpp"
+
+struct Betweenness {
+    std::vector<double> vertex; // shortest paths through each vertex (endpoints excluded)
+    std::vector<double> edge;   // shortest paths along each edge
+    int sources = 0;            // roots the scores were accumulated from
+    double errorBound = 0;      // 0 when exact; else every score is within this of the exact one w.p. 95%
+};
+
+/*
+ * True when b equals a up to the rounding of summing edge weights, so that equally
+ * short paths found along different edges are counted as ties.
+ */
+inline bool sameLength(double a, double b) {
+    return std::abs(a - b) <= 1e-9 * std::max(1.0, std::abs(b));
+}
+
+/*
+ * Brandes betweenness centrality of the vertices and edges for one profile, counting
+ * shortest paths between ordered pairs. Sources run in parallel, each thread with one
+ * reusable workspace (distances, path counts, dependencies) and its own score accumulators,
+ * summed at the end, so memory is O(threads * (n + m)). Predecessors are not stored: the
+ * dependency pass finds them again through the incoming edges.
+ *
+ * With samples > 0 (and fewer than n), only that many sources chosen uniformly at random are used
+ * and the scores are scaled by n / samples (Brandes & Pich). By Hoeffding's inequality with a
+ * union bound over all n + m scores, every estimate is then within
+ * (n - 1) * n * sqrt(ln(2 (n + m) / 0.05) / (2 samples)) of the exact value with 95% probability.
+ */
+template <class T>
+Betweenness computeBetweenness(const CompactGraph<T>& graph, int profile, int samples = 0, unsigned int seed = 1,
+                               unsigned int threads = getThreadCount()) {
+    const std::vector<double>& weights = graph.getWeights(profile);
+    int n = graph.getNumVertex(), m = graph.getNumEdges();
+    threads = std::max(1u, threads);
+
+    std::vector<int> sources(n);
+    std::iota(sources.begin(), sources.end(), 0);
+    bool sampled = samples > 0 && samples < n;
+    if (sampled) {
+        std::mt19937 rng(seed);
+        std::shuffle(sources.begin(), sources.end(), rng);
+        sources.resize(samples);
+    }
+
+    struct Worker {
+        SearchWorkspace ws;
+        std::vector<double> sigma, delta;
+        std::vector<double> vertex, edge;
+    };
+    std::vector<Worker> workers(threads);
+    for (Worker& w : workers) {
+        w.ws.resize(n);
+        w.sigma.assign(n, 0);
+        w.delta.assign(n, 0);
+        w.vertex.assign(n, 0);
+        w.edge.assign(m, 0);
+    }
+
+    parallelFor(sources.size(), [&](int i, unsigned int t) {
+        Worker& w = workers[t];
+        SearchWorkspace& ws = w.ws;
+        ws.reset();
+        int s = sources[i];
+
+        // Dijkstra counting shortest paths
+        SearchQueue pq;
+        ws.reach(s, 0, -1);
+        w.sigma[s] = 1;
+        pq.push({0, s});
+        while (!pq.empty()) {
+            auto [d, u] = pq.top();
+            pq.pop();
+            if (ws.settled[u] || d > ws.dist[u]) continue;
+            ws.settled[u] = true;
+            ws.order.push_back(u);
+            for (int e = graph.edgesBegin(u); e < graph.edgesEnd(u); e++) {
+                if (weights[e] == INF) continue;
+                int v = graph.getHead(e);
+                if (ws.settled[v]) continue;
+                double newDist = d + weights[e];
+                if (ws.dist[v] != INF && sameLength(newDist, ws.dist[v])) {
+                    w.sigma[v] += w.sigma[u];
+                } else if (newDist < ws.dist[v]) {
+                    ws.reach(v, newDist, e);
+                    w.sigma[v] = w.sigma[u];
+                    pq.push({newDist, v});
+                }
+            }
+        }
+
+        // dependencies, farthest vertices first
+        for (auto it = ws.order.rbegin(); it != ws.order.rend(); ++it) {
+            int v = *it;
+            if (v == s) break;
+            for (int j = graph.inEdgesBegin(v); j < graph.inEdgesEnd(v); j++) {
+                int e = graph.getInEdge(j);
+                int u = graph.getTail(e);
+                if (weights[e] == INF || !ws.settled[u] || !sameLength(ws.dist[u] + weights[e], ws.dist[v])) continue;
+                double share = w.sigma[u] / w.sigma[v] * (1 + w.delta[v]);
+                w.edge[e] += share;
+                w.delta[u] += share;
+            }
+            w.vertex[v] += w.delta[v];
+        }
+
+        for (int v : ws.touched) {
+            w.sigma[v] = 0;
+            w.delta[v] = 0;
+        }
+    }, threads);
+
+    Betweenness result;
+    result.sources = sources.size();
+    result.vertex.assign(n, 0);
+    result.edge.assign(m, 0);
+    double scale = sampled ? static_cast<double>(n) / samples : 1;
+    for (const Worker& w : workers) {
+        for (int v = 0; v < n; v++) result.vertex[v] += w.vertex[v] * scale;
+        for (int e = 0; e < m; e++) result.edge[e] += w.edge[e] * scale;
+    }
+    if (sampled) {
+        result.errorBound = (n - 1.0) * n * std::sqrt(std::log(2.0 * (n + m) / 0.05) / (2.0 * samples));
+    }
+    return result;
+}
+
+#endif
@@ -0,0 +1,189 @@
+#ifndef BIDIRECTIONAL_HPP
+#define BIDIRECTIONAL_HPP
+
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "compactgraph.hpp"
+#include "search.hpp"
+
+/******************** BidirectionalSearch ********************/
+
+/*
+ * Point-to-point search growing a forward tree from the source and a backward tree
+ * from the target until they meet. The two directions either alternate on the calling
+ * thread or run on two threads at once; both modes share the same step() code.
+ *
+ * Shared state between the directions:
+ *  - settledDist[dir][v]: distance of v once settled by direction dir, INF before.
+ *    Published with a seq_cst store right after settling and read with seq_cst loads
+ *    (plain loads on x86). When one direction settles u and the other settles v for an
+ *    edge (u, v) at the same time, at least one of them is guaranteed to see the other,
+ *    so no meeting candidate is lost.
+ *  - best: the shortest source-target distance found so far. Read with relaxed loads,
+ *    a stale (larger) value only delays termination.
+ *  - topKey[dir]: key at the top of each queue. Keys only grow, so a stale value is
+ *    smaller than the real one and the stop test topKey[0] + topKey[1] >= best stays safe.
+ */
+template <class T>
+class BidirectionalSearch {
+public:
+    BidirectionalSearch(const CompactGraph<T>& graph, int profile);
+
+    // returns the distance (INF if unreachable); parallel runs each direction on its own thread
+    double run(int source, int target, bool parallel);
+    // edge ids of the path found by the last run, in travel order
+    std::vector<int> getPath() const;
+
+protected:
+    const CompactGraph<T>& graph;
+    const std::vector<double>& weights;
+
+    std::vector<std::atomic<double>> settledDist[2];
+    SearchWorkspace ws[2]; // each only touched by its own direction
+    SearchQueue pq[2];
+
+    std::atomic<double> best;
+    std::atomic<double> topKey[2];
+    std::mutex meetingMutex;
+    int meetingVertex = -1; // the forward tree reaches it, the backward tree leaves from it
+    int meetingEdge = -1;   // edge joining the two trees, -1 if they share meetingVertex
+
+    bool step(int dir);
+    void offerMeeting(double dist, int vertex, int edge);
+};
+
+/************************* BidirectionalSearch  **************************/
+
+template <class T>
+BidirectionalSearch<T>::BidirectionalSearch(const CompactGraph<T>& graph, int profile)
+    : graph(graph), weights(graph.getWeights(profile)), best(INF) {
+    int n = graph.getNumVertex();
+    for (int dir = 0; dir < 2; dir++) {
+        settledDist[dir] = std::vector<std::atomic<double>>(n);
+        for (auto& d : settledDist[dir]) d.store(INF, std::memory_order_relaxed);
+        ws[dir].resize(n);
+        topKey[dir].store(0, std::memory_order_relaxed);
+    }
+}
+
+template <class T>
+void BidirectionalSearch<T>::offerMeeting(double dist, int vertex, int edge) {
+    if (dist >= best.load(std::memory_order_relaxed)) return;
+    std::lock_guard<std::mutex> lock(meetingMutex);
+    if (dist >= best.load(std::memory_order_relaxed)) return;
+    meetingVertex = vertex;
+    meetingEdge = edge;
+    best.store(dist, std::memory_order_relaxed);
+}
+
+/*
+ * Settles one vertex in direction dir (0 forward, 1 backward).
+ * Returns false once this direction can stop.
+ */
+template <class T>
+bool BidirectionalSearch<T>::step(int dir) {
+    int other = 1 - dir;
+    SearchWorkspace& own = ws[dir];
+
+    while (!pq[dir].empty() && (own.settled[pq[dir].top().second] || pq[dir].top().first > own.dist[pq[dir].top().second])) {
+        pq[dir].pop(); // drop stale entries
+    }
+    if (pq[dir].empty()) {
+        topKey[dir].store(INF, std::memory_order_relaxed);
+        return false;
+    }
+
+    auto [d, u] = pq[dir].top();
+    topKey[dir].store(d, std::memory_order_relaxed);
+    // the root must be settled first: the stop test relies on every vertex closer than the
+    // top key having been scanned, which only holds once the queue has moved past the root
+    if (!own.order.empty() && d + topKey[other].load(std::memory_order_relaxed) >= best.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    pq[dir].pop();
+
+    own.settled[u] = true;
+    own.order.push_back(u);
+    settledDist[dir][u].store(d, std::memory_order_seq_cst);
+    double meet = settledDist[other][u].load(std::memory_order_seq_cst);
+    if (meet != INF) offerMeeting(d + meet, u, -1);
+
+    bool backward = dir == 1;
+    int begin = backward ? graph.inEdgesBegin(u) : graph.edgesBegin(u);
+    int end = backward ? graph.inEdgesEnd(u) : graph.edgesEnd(u);
+    for (int i = begin; i < end; i++) {
+        int e = backward ? graph.getInEdge(i) : i;
+        double w = weights[e];
+        if (w == INF) continue;
+        int v = backward ? graph.getTail(e) : graph.getHead(e);
+
+        double otherDist = settledDist[other][v].load(std::memory_order_seq_cst);
+        if (otherDist != INF) offerMeeting(d + w + otherDist, backward ? v : u, e);
+
+        if (d + w < own.dist[v]) {
+            own.reach(v, d + w, e);
+            pq[dir].push({d + w, v});
+        }
+    }
+    return true;
+}
+
+template <class T>
+double BidirectionalSearch<T>::run(int source, int target, bool parallel) {
+    int n = graph.getNumVertex();
+    if (source < 0 || source >= n || target < 0 || target >= n) {
+        throw std::runtime_error("Bidirectional search error: invalid vertex index\n");
+    }
+
+    for (int dir = 0; dir < 2; dir++) {
+        for (int v : ws[dir].touched) settledDist[dir][v].store(INF, std::memory_order_relaxed);
+        ws[dir].reset();
+        pq[dir] = SearchQueue();
+        topKey[dir].store(0, std::memory_order_relaxed);
+    }
+    best.store(INF, std::memory_order_relaxed);
+    meetingVertex = -1;
+    meetingEdge = -1;
+
+    ws[0].reach(source, 0, -1);
+    pq[0].push({0, source});
+    ws[1].reach(target, 0, -1);
+    pq[1].push({0, target});
+
+    if (parallel) {
+        std::thread backward([this]() { while (step(1)); });
+        while (step(0));
+        backward.join();
+    } else {
+        bool forwardActive = true, backwardActive = true;
+        while (forwardActive || backwardActive) {
+            // advance the direction with the smaller queue, as the sequential variant usually does
+            bool forwardTurn = forwardActive && (!backwardActive || pq[0].size() <= pq[1].size());
+            if (forwardTurn) forwardActive = step(0);
+            else backwardActive = step(1);
+        }
+    }
+
+    return best.load();
+}
+
+template <class T>
+std::vector<int> BidirectionalSearch<T>::getPath() const {
+    std::vector<int> path;
+    if (meetingVertex == -1) return path;
+
+    int forwardEnd = meetingVertex;
+    if (meetingEdge != -1) forwardEnd = graph.getTail(meetingEdge);
+    path = extractPath(graph, ws[0], forwardEnd);
+
+    if (meetingEdge != -1) path.push_back(meetingEdge);
+    int backwardStart = meetingEdge != -1 ? graph.getHead(meetingEdge) : meetingVertex;
+    std::vector<int> rest = extractPath(graph, ws[1], backwardStart, true);
+    path.insert(path.end(), rest.begin(), rest.end());
+    return path;
+}
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef CLOSURE_HPP
+#define CLOSURE_HPP
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+#include "compactgraph.hpp"
+#include "parallel.hpp"
+#include "placement.hpp"
+#include "search.hpp"
+
+struct ClosureImpact {
+    int closure;         // position in the list of closures
+    double delay = 0;    // extra weighted driving time over the pairs that stay connected
+    int affected = 0;    // pairs whose current route uses a closed edge
+    int disconnected = 0; // pairs left without any route
+};
+
+/*
+ * What-if analysis of road closures over a set of origin/destination pairs. Every closure
+ * is a set of edge ids closed together (e.g. both directions of a segment).
+ *
+ * One driving tree per distinct origin gives every pair's current route; closing edges
+ * that are not on a pair's route cannot slow it down, so for each closure only the pairs
+ * whose route contains one of its edges are searched again, with the closed edges removed.
+ * Closures are evaluated in parallel, each thread on its own copy of the weights where it
+ * sets the closed edges to INF and restores them afterwards.
+ * Results come ranked: most disconnected pairs first, then largest delay.
+ */
+template <class T>
+std::vector<ClosureImpact> analyseClosures(const CompactGraph<T>& graph, const std::vector<Demand>& demand,
+                                           const std::vector<std::vector<int>>& closures) {
+    const std::vector<double>& driving = graph.getWeights(DRIVING);
+    unsigned int threads = getThreadCount();
+    std::vector<SearchWorkspace> ws(threads);
+
+    std::vector<int> origins;
+    std::unordered_map<int, int> originIndex;
+    std::vector<std::vector<int>> tripsFrom;
+    for (size_t i = 0; i < demand.size(); i++) {
+        if (originIndex.insert({demand[i].origin, static_cast<int>(origins.size())}).second) {
+            origins.push_back(demand[i].origin);
+            tripsFrom.push_back({});
+        }
+        tripsFrom[originIndex[demand[i].origin]].push_back(i);
+    }
+
+    // only the edges some closure contains need their users listed
+    std::vector<int> watched(graph.getNumEdges(), -1);
+    int watchedCount = 0;
+    for (const std::vector<int>& closure : closures) {
+        for (int e : closure) {
+            if (watched[e] == -1) watched[e] = watchedCount++;
+        }
+    }
+
+    std::vector<double> base(demand.size(), INF);
+    std::vector<std::vector<std::pair<int, int>>> uses(origins.size()); // (watched edge, pair) per origin
+    parallelFor(origins.size(), [&](int o, unsigned int t) {
+        shortestPathTree(graph, driving, origins[o], ws[t]);
+        for (int trip : tripsFrom[o]) {
+            base[trip] = ws[t].dist[demand[trip].destination];
+            if (base[trip] == INF) continue;
+            for (int e : extractPath(graph, ws[t], demand[trip].destination)) {
+                if (watched[e] != -1) uses[o].push_back({watched[e], trip});
+            }
+        }
+    }, threads);
+
+    std::vector<std::vector<int>> users(watchedCount); // pairs routed over each watched edge
+    for (const auto& list : uses) {
+        for (const auto& [w, trip] : list) users[w].push_back(trip);
+    }
+
+    std::vector<std::vector<double>> weights(threads, driving);
+    std::vector<std::vector<char>> seen(threads, std::vector<char>(demand.size(), false));
+    std::vector<ClosureImpact> impacts(closures.size());
+    parallelFor(closures.size(), [&](int c, unsigned int t) {
+        ClosureImpact& impact = impacts[c];
+        impact.closure = c;
+        std::vector<int> affected;
+        for (int e : closures[c]) {
+            weights[t][e] = INF;
+            for (int trip : users[watched[e]]) {
+                if (!seen[t][trip]) {
+                    seen[t][trip] = true;
+                    affected.push_back(trip);
+                }
+            }
+        }
+
+        for (int trip : affected) {
+            seen[t][trip] = false;
+            double dist = shortestPath(graph, weights[t], demand[trip].origin, demand[trip].destination, ws[t]);
+            if (dist == INF) impact.disconnected++;
+            else impact.delay += demand[trip].weight * (dist - base[trip]);
+        }
+        impact.affected = affected.size();
+        for (int e : closures[c]) weights[t][e] = driving[e];
+    }, threads);
+
+    std::stable_sort(impacts.begin(), impacts.end(), [](const ClosureImpact& a, const ClosureImpact& b) {
+        if (a.disconnected != b.disconnected) return a.disconnected > b.disconnected;
+        return a.delay > b.delay;
+    });
+    return impacts;
+}
+
+#endif
@@ -0,0 +1,261 @@
+#ifndef COMPACTGRAPH_HPP
+#define COMPACTGRAPH_HPP
+
+#include <algorithm>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "graph.hpp"
+
+// weight columns every snapshot carries, in this order; named profiles are added after them
+enum TravelMode { DRIVING = 0, WALKING = 1 };
+
+/******************** CompactGraph ********************/
+
+/*
+ * Read-only, index-based snapshot of a Graph laid out as flat arrays (CSR).
+ * Vertices are numbered 0..n-1 by ascending id, edges are grouped by origin.
+ * Searches over the snapshot keep their state in their own arrays instead of the
+ * Vertex fields, so several of them can run at the same time.
+ * Edge and vertex availability are baked into the driving weights when the snapshot
+ * is taken (unavailable -> INF); walking ignores them, as dijkstraWalking does.
+ *
+ * Every profile (driving, walking and any named one added later) is its own contiguous
+ * weight column, so a search picks its profile once by taking a column reference and
+ * only ever reads that column. Columns are never moved once added.
+ */
+template <class T>
+class CompactGraph {
+public:
+    explicit CompactGraph(const Graph<T>& graph);
+
+    int getNumVertex() const;
+    int getNumEdges() const;
+    // index of the vertex with the given id, -1 if it does not exist
+    int findIndex(const T& in) const;
+    const T& getInfo(int v) const;
+    Vertex<T>* getVertex(int v) const;
+    bool hasParking(int v) const;
+    // true when every vertex has a latitude and longitude
+    bool hasCoordinates() const;
+    double getLatitude(int v) const;
+    double getLongitude(int v) const;
+
+    // outgoing edges of v are the edge ids in [edgesBegin(v), edgesEnd(v))
+    int edgesBegin(int v) const;
+    int edgesEnd(int v) const;
+    int getTail(int e) const;
+    int getHead(int e) const;
+    Edge<T>* getEdge(int e) const;
+
+    // incoming edges of v are getInEdge(i) for i in [inEdgesBegin(v), inEdgesEnd(v))
+    int inEdgesBegin(int v) const;
+    int inEdgesEnd(int v) const;
+    int getInEdge(int i) const;
+
+    // contiguous per-edge weight column of a profile (DRIVING, WALKING or a named one)
+    const std::vector<double>& getWeights(int profile) const;
+    int getNumProfiles() const;
+    // index of the profile with the given name, -1 if it does not exist
+    int findProfile(const std::string& name) const;
+    const std::string& getProfileName(int profile) const;
+    // adds a named profile (weights indexed by edge id, INF where it cannot go), or replaces
+    // the weights of an existing named one; returns its index
+    int addWeightColumn(const std::string& name, std::vector<double> weights);
+
+protected:
+    std::vector<T> info;
+    std::vector<Vertex<T>*> vertices;
+    std::unordered_map<T, int> indexOf;
+    std::vector<char> parking;
+    bool coordinates = false;
+    std::vector<double> latitudes;
+    std::vector<double> longitudes;
+
+    std::vector<int> offsets; // n + 1 entries
+    std::vector<int> tails;
+    std::vector<int> heads;
+    std::vector<Edge<T>*> edges;
+
+    std::vector<int> inOffsets; // n + 1 entries
+    std::vector<int> inEdges;
+
+    std::deque<std::vector<double>> weightColumns; // deque: adding a column keeps references valid
+    std::vector<std::string> profileNames{"driving", "walking"};
+};
+
+/************************* CompactGraph  **************************/
+
+template <class T>
+CompactGraph<T>::CompactGraph(const Graph<T>& graph) {
+    vertices = graph.getVertexSet();
+    std::sort(vertices.begin(), vertices.end(), [](Vertex<T>* a, Vertex<T>* b) {
+        return a->getInfo() < b->getInfo();
+    });
+
+    int n = vertices.size();
+    info.reserve(n);
+    parking.reserve(n);
+    coordinates = n > 0;
+    for (int v = 0; v < n; v++) {
+        info.push_back(vertices[v]->getInfo());
+        parking.push_back(vertices[v]->hasParking());
+        latitudes.push_back(vertices[v]->getLatitude());
+        longitudes.push_back(vertices[v]->getLongitude());
+        coordinates = coordinates && vertices[v]->hasCoordinates();
+        indexOf[vertices[v]->getInfo()] = v;
+    }
+
+    weightColumns.resize(2);
+    offsets.assign(n + 1, 0);
+    for (int v = 0; v < n; v++) {
+        for (Edge<T>* edge : vertices[v]->getAdj()) {
+            int head = indexOf.at(edge->getDest()->getInfo());
+            bool drivable = edge->isAvailable() && edge->getDest()->isAvailable();
+            tails.push_back(v);
+            heads.push_back(head);
+            edges.push_back(edge);
+            weightColumns[DRIVING].push_back(drivable ? edge->getDriveTime() : INF);
+            weightColumns[WALKING].push_back(edge->getWalkTime());
+        }
+        offsets[v + 1] = edges.size();
+    }
+
+    // reverse adjacency, built by counting sort on the heads
+    int m = edges.size();
+    inOffsets.assign(n + 1, 0);
+    for (int e = 0; e < m; e++) inOffsets[heads[e] + 1]++;
+    for (int v = 0; v < n; v++) inOffsets[v + 1] += inOffsets[v];
+    inEdges.resize(m);
+    std::vector<int> fill(inOffsets.begin(), inOffsets.end() - 1);
+    for (int e = 0; e < m; e++) inEdges[fill[heads[e]]++] = e;
+}
+
+template <class T>
+int CompactGraph<T>::getNumVertex() const {
+    return info.size();
+}
+
+template <class T>
+int CompactGraph<T>::getNumEdges() const {
+    return heads.size();
+}
+
+template <class T>
+int CompactGraph<T>::findIndex(const T& in) const {
+    auto it = indexOf.find(in);
+    return (it != indexOf.end()) ? it->second : -1;
+}
+
+template <class T>
+const T& CompactGraph<T>::getInfo(int v) const {
+    return info[v];
+}
+
+template <class T>
+Vertex<T>* CompactGraph<T>::getVertex(int v) const {
+    return vertices[v];
+}
+
+template <class T>
+bool CompactGraph<T>::hasParking(int v) const {
+    return parking[v];
+}
+
+template <class T>
+bool CompactGraph<T>::hasCoordinates() const {
+    return coordinates;
+}
+
+template <class T>
+double CompactGraph<T>::getLatitude(int v) const {
+    return latitudes[v];
+}
+
+template <class T>
+double CompactGraph<T>::getLongitude(int v) const {
+    return longitudes[v];
+}
+
+template <class T>
+int CompactGraph<T>::edgesBegin(int v) const {
+    return offsets[v];
+}
+
+template <class T>
+int CompactGraph<T>::edgesEnd(int v) const {
+    return offsets[v + 1];
+}
+
+template <class T>
+int CompactGraph<T>::getTail(int e) const {
+    return tails[e];
+}
+
+template <class T>
+int CompactGraph<T>::getHead(int e) const {
+    return heads[e];
+}
+
+template <class T>
+Edge<T>* CompactGraph<T>::getEdge(int e) const {
+    return edges[e];
+}
+
+template <class T>
+int CompactGraph<T>::inEdgesBegin(int v) const {
+    return inOffsets[v];
+}
+
+template <class T>
+int CompactGraph<T>::inEdgesEnd(int v) const {
+    return inOffsets[v + 1];
+}
+
+template <class T>
+int CompactGraph<T>::getInEdge(int i) const {
+    return inEdges[i];
+}
+
+template <class T>
+const std::vector<double>& CompactGraph<T>::getWeights(int profile) const {
+    return weightColumns[profile];
+}
+
+template <class T>
+int CompactGraph<T>::getNumProfiles() const {
+    return weightColumns.size();
+}
+
+template <class T>
+int CompactGraph<T>::findProfile(const std::string& name) const {
+    auto it = std::find(profileNames.begin(), profileNames.end(), name);
+    return (it != profileNames.end()) ? static_cast<int>(it - profileNames.begin()) : -1;
+}
+
+template <class T>
+const std::string& CompactGraph<T>::getProfileName(int profile) const {
+    return profileNames[profile];
+}
+
+template <class T>
+int CompactGraph<T>::addWeightColumn(const std::string& name, std::vector<double> weights) {
+    if (static_cast<int>(weights.size()) != getNumEdges()) {
+        throw std::runtime_error("Profile error: " + name + " does not have one weight per edge\n");
+    }
+    int profile = findProfile(name);
+    if (profile == DRIVING || profile == WALKING) {
+        throw std::runtime_error("Profile error: " + name + " is a built-in profile\n");
+    }
+    if (profile != -1) {
+        weightColumns[profile] = std::move(weights);
+        return profile;
+    }
+    profileNames.push_back(name);
+    weightColumns.push_back(std::move(weights));
+    return weightColumns.size() - 1;
+}
+
+#endif
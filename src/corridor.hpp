@@ -0,0 +1,46 @@
+#ifndef CORRIDOR_HPP
+#define CORRIDOR_HPP
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "compactgraph.hpp"
+#include "search.hpp"
+
+struct CorridorParking {
+    int vertex;    // snapshot index of the parking
+    int exit;      // route vertex where the driver leaves the route for it
+    double detour; // driving time from the route to the parking
+    double walk;   // walking time from the parking to the destination
+};
+
+/*
+ * Parking along a driving route (snapshot indices, in order) whose detour from the route plus
+ * the walk to the destination fits in budget, cheapest first.
+ * A single driving search is seeded with every route vertex at distance 0, so the distance it
+ * finds is the detour from the nearest point of the route, and the root each vertex is reached
+ * from is its exit. One walking search goes backwards from the destination. Both stop at the
+ * budget.
+ */
+template <class T>
+std::vector<CorridorParking> corridorParking(const CompactGraph<T>& graph, const std::vector<int>& route, int destination,
+                                             double budget, SearchWorkspace& drive, SearchWorkspace& walk) {
+    std::vector<std::pair<int, double>> seeds;
+    for (int v : route) seeds.push_back({v, 0});
+    shortestPathTree(graph, graph.getWeights(DRIVING), seeds, drive, budget);
+    shortestPathTree(graph, graph.getWeights(WALKING), destination, walk, budget, true);
+
+    std::vector<CorridorParking> result;
+    std::vector<int> exit(graph.getNumVertex(), -1);
+    for (int v : drive.order) {
+        exit[v] = drive.parent[v] == -1 ? v : exit[graph.getTail(drive.parent[v])];
+        if (!graph.hasParking(v) || !walk.settled[v]) continue;
+        if (drive.dist[v] + walk.dist[v] <= budget) result.push_back({v, exit[v], drive.dist[v], walk.dist[v]});
+    }
+    std::stable_sort(result.begin(), result.end(), [](const CorridorParking& a, const CorridorParking& b) {
+        return a.detour + a.walk < b.detour + b.walk;
+    });
+    return result;
+}
+
+#endif
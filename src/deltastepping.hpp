@@ -0,0 +1,217 @@
+#ifndef DELTASTEPPING_HPP
+#define DELTASTEPPING_HPP
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include "compactgraph.hpp"
+#include "parallel.hpp"
+
+/******************** DeltaStepping ********************/
+
+/*
+ * Parallel single-source shortest path trees (Meyer & Sanders' delta-stepping).
+ * Tentative distances are kept in buckets of width delta. The vertices of the current
+ * bucket relax their light edges (weight <= delta) repeatedly until the bucket stays
+ * empty, then relax their heavy edges once.
+ * Each phase has two parallel steps with no shared writes:
+ *  - generation: every thread scans a slice of the frontier and appends relaxation
+ *    requests to its own buffers, one buffer per owner thread (owner = vertex % threads);
+ *  - application: every thread applies the requests addressed to the vertices it owns.
+ * The light/heavy split is precomputed once per engine, so run() can be called for many
+ * sources. The steps run on a worker pool kept for the engine's lifetime, as a tree takes
+ * thousands of them and starting threads for each would eat the parallel speedup.
+ */
+template <class T>
+class DeltaStepping {
+public:
+    // delta <= 0 picks the mean finite edge weight; delta is at least the smallest positive one
+    DeltaStepping(const CompactGraph<T>& graph, int profile, double delta = 0, unsigned int threads = getThreadCount());
+
+    void run(int source);
+    const std::vector<double>& getDistances() const;
+    const std::vector<int>& getParents() const; // edge ids, -1 for the source and unreachable vertices
+    double getDelta() const;
+
+protected:
+    struct Request {
+        int vertex;
+        int edge;
+        double dist;
+    };
+
+    const CompactGraph<T>& graph;
+    const std::vector<double>& weights;
+    double delta;
+    unsigned int threads;
+    WorkerPool pool;
+
+    std::vector<int> edgeOrder; // per vertex: light edge ids first, then heavy
+    std::vector<int> heavyBegin;
+
+    std::vector<double> dist;
+    std::vector<int> parents;
+    std::vector<std::vector<int>> buckets;
+    std::vector<std::vector<std::vector<Request>>> requests; // [generating thread][owner thread]
+    std::vector<std::vector<int>> improved; // per owner thread
+
+    void relaxEdges(const std::vector<int>& frontier, bool light);
+    void insertInBucket(int v);
+};
+
+/************************* DeltaStepping  **************************/
+
+template <class T>
+DeltaStepping<T>::DeltaStepping(const CompactGraph<T>& graph, int profile, double delta, unsigned int threads)
+    : graph(graph), weights(graph.getWeights(profile)), delta(delta), threads(std::max(1u, threads)),
+      pool(this->threads) {
+    double sum = 0, smallest = INF;
+    int count = 0;
+    for (double w : weights) {
+        if (w == INF) continue;
+        sum += w;
+        count++;
+        if (w > 0) smallest = std::min(smallest, w);
+    }
+    if (this->delta <= 0) this->delta = (count > 0 && sum > 0) ? sum / count : 1;
+    // narrower buckets than the smallest edge only add empty ones, and a tiny delta would need billions
+    if (smallest != INF) this->delta = std::max(this->delta, smallest);
+
+    int n = graph.getNumVertex();
+    edgeOrder.reserve(graph.getNumEdges());
+    heavyBegin.resize(n);
+    for (int v = 0; v < n; v++) {
+        for (int e = graph.edgesBegin(v); e < graph.edgesEnd(v); e++) {
+            if (weights[e] <= this->delta) edgeOrder.push_back(e);
+        }
+        heavyBegin[v] = edgeOrder.size();
+        for (int e = graph.edgesBegin(v); e < graph.edgesEnd(v); e++) {
+            if (weights[e] > this->delta && weights[e] != INF) edgeOrder.push_back(e);
+        }
+        // unusable edges are dropped, pad so that edgeOrder stays aligned with the CSR offsets
+        while (static_cast<int>(edgeOrder.size()) < graph.edgesEnd(v)) edgeOrder.push_back(-1);
+    }
+
+    requests.assign(this->threads, std::vector<std::vector<Request>>(this->threads));
+    improved.assign(this->threads, {});
+}
+
+template <class T>
+void DeltaStepping<T>::insertInBucket(int v) {
+    size_t b = static_cast<size_t>(dist[v] / delta);
+    if (b >= buckets.size()) buckets.resize(b + 1);
+    buckets[b].push_back(v);
+}
+
+/*
+ * Relaxes the light (or heavy) edges of every vertex in the frontier and
+ * re-buckets the vertices whose distance improved.
+ */
+template <class T>
+void DeltaStepping<T>::relaxEdges(const std::vector<int>& frontier, bool light) {
+    int size = frontier.size();
+    unsigned int workers = std::min<unsigned int>(threads, std::max(1, size / 64));
+    int chunk = (size + workers - 1) / workers;
+
+    pool.run(workers, [&](unsigned int t) {
+        std::vector<std::vector<Request>>& out = requests[t];
+        for (auto& buffer : out) buffer.clear();
+        int first = t * chunk;
+        int last = std::min(size, first + chunk);
+        for (int i = first; i < last; i++) {
+            int u = frontier[i];
+            int begin = light ? graph.edgesBegin(u) : heavyBegin[u];
+            int end = light ? heavyBegin[u] : graph.edgesEnd(u);
+            for (int j = begin; j < end; j++) {
+                int e = edgeOrder[j];
+                if (e == -1) break;
+                int v = graph.getHead(e);
+                double newDist = dist[u] + weights[e];
+                if (newDist < dist[v]) out[v % threads].push_back({v, e, newDist}); // dist is read-only here
+            }
+        }
+    });
+
+    // a single generating thread is applied inline, owner after owner
+    unsigned int appliers = workers > 1 ? threads : 1;
+    pool.run(appliers, [&](unsigned int a) {
+        for (unsigned int owner = a; owner < threads; owner += appliers) {
+            improved[owner].clear();
+            for (unsigned int t = 0; t < workers; t++) {
+                for (const Request& r : requests[t][owner]) {
+                    if (r.dist < dist[r.vertex]) {
+                        dist[r.vertex] = r.dist;
+                        parents[r.vertex] = r.edge;
+                        improved[owner].push_back(r.vertex);
+                    }
+                }
+            }
+        }
+    });
+
+    for (unsigned int owner = 0; owner < threads; owner++) {
+        for (int v : improved[owner]) insertInBucket(v);
+    }
+}
+
+template <class T>
+void DeltaStepping<T>::run(int source) {
+    int n = graph.getNumVertex();
+    if (source < 0 || source >= n) {
+        throw std::runtime_error("Delta-stepping error: invalid source index " + std::to_string(source) + "\n");
+    }
+
+    dist.assign(n, INF);
+    parents.assign(n, -1);
+    buckets.clear();
+    for (unsigned int t = 0; t < threads; t++) {
+        for (auto& buffer : requests[t]) buffer.clear();
+    }
+
+    // stamps used to deduplicate bucket entries, one per light round and one per bucket
+    std::vector<int> inFrontier(n, -1), inSettled(n, -1);
+    std::vector<int> frontier, settled, current;
+    int round = 0;
+
+    dist[source] = 0;
+    insertInBucket(source);
+
+    for (size_t i = 0; i < buckets.size(); i++) {
+        settled.clear();
+        while (!buckets[i].empty()) {
+            frontier.clear();
+            current.clear();
+            current.swap(buckets[i]);
+            for (int v : current) {
+                // stale entries were re-bucketed with a smaller distance
+                if (static_cast<size_t>(dist[v] / delta) != i || inFrontier[v] == round) continue;
+                inFrontier[v] = round;
+                frontier.push_back(v);
+                if (inSettled[v] != static_cast<int>(i)) {
+                    inSettled[v] = i;
+                    settled.push_back(v);
+                }
+            }
+            round++;
+            if (!frontier.empty()) relaxEdges(frontier, true);
+        }
+        if (!settled.empty()) relaxEdges(settled, false);
+    }
+}
+
+template <class T>
+const std::vector<double>& DeltaStepping<T>::getDistances() const {
+    return dist;
+}
+
+template <class T>
+const std::vector<int>& DeltaStepping<T>::getParents() const {
+    return parents;
+}
+
+template <class T>
+double DeltaStepping<T>::getDelta() const {
+    return delta;
+}
+
+#endif
@@ -0,0 +1,230 @@
+#ifndef FLEET_HPP
+#define FLEET_HPP
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "compactgraph.hpp"
+#include "parallel.hpp"
+#include "search.hpp"
+
+struct FleetAssignment {
+    std::vector<int> vehicle;  // per request, the vehicle (position in the input) sent to it, -1 if none
+    std::vector<double> time;  // per request, driving time of that vehicle to the pickup
+    int served = 0;
+    double totalTime = 0;      // over the served requests
+    int feasiblePairs = 0;     // entries of the sparse matrix
+};
+
+/******************** FleetDispatcher ********************/
+
+/*
+ * Minimum-cost matching of idle vehicles to pickup requests (snapshot indices) on driving time.
+ *
+ * The vehicle x request matrix is sparse: one forward search per distinct vehicle vertex,
+ * bounded by the pickup cutoff and run in parallel, lists the requests it reaches in time; the
+ * other pairs are infeasible and never stored. The entries are regrouped per request in flat
+ * arrays.
+ *
+ * The assignment problem is solved with the Jonker-Volgenant shortest augmenting path method on
+ * the sparse rows: every request first takes its cheapest free column, then each remaining one
+ * is augmented by a Dijkstra over reduced costs that stops at the first free column, after which
+ * the column prices of the scanned columns are updated. Each request also has a private dummy
+ * column costing unservedCost, so the matching always exists and a request is only left unserved
+ * when serving it would cost more than that.
+ */
+template <class T>
+class FleetDispatcher {
+public:
+    explicit FleetDispatcher(const CompactGraph<T>& graph);
+
+    FleetAssignment assign(const std::vector<int>& vehicles, const std::vector<int>& requests, double cutoff,
+                           double unservedCost);
+
+protected:
+    const CompactGraph<T>& graph;
+    std::vector<SearchWorkspace> ws; // per thread, reused across calls
+
+    // pairs of request r: (column, cost) for i in [rowBegin[r], rowBegin[r + 1])
+    std::vector<int> rowBegin;
+    std::vector<std::pair<int, double>> entries;
+
+    void buildMatrix(const std::vector<int>& vehicles, const std::vector<int>& requests, double cutoff, double unservedCost);
+    std::vector<int> solve(int rows, int columns);
+};
+
+/************************* FleetDispatcher  **************************/
+
+template <class T>
+FleetDispatcher<T>::FleetDispatcher(const CompactGraph<T>& graph) : graph(graph), ws(getThreadCount()) {}
+
+template <class T>
+void FleetDispatcher<T>::buildMatrix(const std::vector<int>& vehicles, const std::vector<int>& requests, double cutoff,
+                                     double unservedCost) {
+    int vehicleCount = vehicles.size(), requestCount = requests.size();
+
+    // requests waiting at each vertex
+    std::vector<int> slot(graph.getNumVertex(), -1);
+    std::vector<std::vector<int>> waiting;
+    for (int r = 0; r < requestCount; r++) {
+        if (slot[requests[r]] == -1) {
+            slot[requests[r]] = waiting.size();
+            waiting.push_back({});
+        }
+        waiting[slot[requests[r]]].push_back(r);
+    }
+
+    // vehicles sharing a vertex share its search
+    std::unordered_map<int, int> originIndex;
+    std::vector<int> origins;
+    std::vector<std::vector<int>> parked;
+    for (int v = 0; v < vehicleCount; v++) {
+        auto [it, inserted] = originIndex.insert({vehicles[v], static_cast<int>(origins.size())});
+        if (inserted) {
+            origins.push_back(vehicles[v]);
+            parked.push_back({});
+        }
+        parked[it->second].push_back(v);
+    }
+
+    std::vector<std::vector<std::pair<int, double>>> reached(origins.size()); // (request, time) per origin
+    parallelFor(origins.size(), [&](int o, unsigned int t) {
+        shortestPathTree(graph, graph.getWeights(DRIVING), origins[o], ws[t], cutoff);
+        for (int u : ws[t].order) {
+            if (slot[u] == -1) continue;
+            for (int r : waiting[slot[u]]) reached[o].push_back({r, ws[t].dist[u]});
+        }
+    }, ws.size());
+
+    // regroup by request, counting sort, with the dummy column of each request last
+    rowBegin.assign(requestCount + 1, 0);
+    for (size_t o = 0; o < origins.size(); o++) {
+        for (const auto& [r, time] : reached[o]) rowBegin[r + 1] += parked[o].size();
+    }
+    for (int r = 0; r < requestCount; r++) rowBegin[r + 1] += rowBegin[r] + 1;
+    entries.resize(rowBegin[requestCount]);
+    std::vector<int> fill(rowBegin.begin(), rowBegin.end() - 1);
+    for (size_t o = 0; o < origins.size(); o++) {
+        for (const auto& [r, time] : reached[o]) {
+            for (int v : parked[o]) entries[fill[r]++] = {v, time};
+        }
+    }
+    for (int r = 0; r < requestCount; r++) entries[fill[r]] = {vehicleCount + r, unservedCost};
+}
+
+template <class T>
+std::vector<int> FleetDispatcher<T>::solve(int rows, int columns) {
+    std::vector<int> rowColumn(rows, -1), columnRow(columns, -1);
+    std::vector<double> price(columns, 0); // reduced cost of (r, c) is cost - price[c] - (cost of r's column - its price)
+
+    // initial greedy pass: the cheapest column of each row, when it is still free
+    std::vector<int> pending;
+    for (int r = 0; r < rows; r++) {
+        int best = rowBegin[r];
+        for (int i = rowBegin[r]; i < rowBegin[r + 1]; i++) {
+            if (entries[i].second < entries[best].second) best = i;
+        }
+        int c = entries[best].first;
+        if (columnRow[c] == -1) {
+            columnRow[c] = r;
+            rowColumn[r] = best;
+        } else {
+            pending.push_back(r);
+        }
+    }
+
+    std::vector<double> dist(columns, INF);
+    std::vector<int> via(columns, -1); // entry that reached the column
+    std::vector<char> scanned(columns, false);
+    std::vector<int> touched, done;
+    for (int start : pending) {
+        SearchQueue pq;
+        for (int i = rowBegin[start]; i < rowBegin[start + 1]; i++) {
+            int c = entries[i].first;
+            double d = entries[i].second - price[c];
+            if (dist[c] == INF) touched.push_back(c);
+            if (d < dist[c]) {
+                dist[c] = d;
+                via[c] = i;
+                pq.push({d, c});
+            }
+        }
+
+        int freeColumn = -1;
+        double length = 0;
+        while (!pq.empty()) {
+            auto [d, c] = pq.top();
+            pq.pop();
+            if (scanned[c] || d > dist[c]) continue;
+            if (columnRow[c] == -1) {
+                freeColumn = c;
+                length = d;
+                break;
+            }
+            scanned[c] = true;
+            done.push_back(c);
+            int r = columnRow[c];
+            double base = entries[rowColumn[r]].second - price[c];
+            for (int i = rowBegin[r]; i < rowBegin[r + 1]; i++) {
+                int next = entries[i].first;
+                if (scanned[next]) continue;
+                double nd = d + entries[i].second - price[next] - base;
+                if (dist[next] == INF) touched.push_back(next);
+                if (nd < dist[next]) {
+                    dist[next] = nd;
+                    via[next] = i;
+                    pq.push({nd, next});
+                }
+            }
+        }
+
+        // prices of the scanned columns, then flip the path (the dummy column is always free)
+        for (int c : done) price[c] += dist[c] - length;
+        for (int c = freeColumn; c != -1;) {
+            int i = via[c];
+            int r = std::upper_bound(rowBegin.begin(), rowBegin.end(), i) - rowBegin.begin() - 1;
+            int previous = rowColumn[r] == -1 ? -1 : entries[rowColumn[r]].first;
+            columnRow[c] = r;
+            rowColumn[r] = i;
+            c = previous;
+        }
+
+        for (int c : touched) {
+            dist[c] = INF;
+            via[c] = -1;
+            scanned[c] = false;
+        }
+        touched.clear();
+        done.clear();
+    }
+
+    std::vector<int> assignment(rows);
+    for (int r = 0; r < rows; r++) assignment[r] = entries[rowColumn[r]].first;
+    return assignment;
+}
+
+template <class T>
+FleetAssignment FleetDispatcher<T>::assign(const std::vector<int>& vehicles, const std::vector<int>& requests,
+                                           double cutoff, double unservedCost) {
+    int vehicleCount = vehicles.size(), requestCount = requests.size();
+    buildMatrix(vehicles, requests, cutoff, unservedCost);
+    std::vector<int> columns = solve(requestCount, vehicleCount + requestCount);
+
+    FleetAssignment result;
+    result.feasiblePairs = entries.size() - requestCount;
+    result.vehicle.assign(requestCount, -1);
+    result.time.assign(requestCount, INF);
+    for (int r = 0; r < requestCount; r++) {
+        if (columns[r] >= vehicleCount) continue;
+        result.vehicle[r] = columns[r];
+        for (int i = rowBegin[r]; i < rowBegin[r + 1]; i++) {
+            if (entries[i].first == columns[r]) result.time[r] = entries[i].second;
+        }
+        result.served++;
+        result.totalTime += result.time[r];
+    }
+    return result;
+}
+
+#endif
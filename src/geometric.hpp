@@ -0,0 +1,100 @@
+#ifndef GEOMETRIC_HPP
+#define GEOMETRIC_HPP
+
+#include <cmath>
+#include <vector>
+#include "compactgraph.hpp"
+#include "search.hpp"
+#include "spatial.hpp"
+
+/******************** GeometricBound ********************/
+
+/*
+ * Lower bound on the travel time between two vertices from their positions alone,
+ * for goal-directed (A*) searches that need no preprocessing beyond the loaded weights.
+ *
+ * The bound is the straight 3D chord between the two points divided by the fastest
+ * speed observed on any edge of the profile (great-circle length / weight). The chord is
+ * never longer than the great-circle distance and obeys the triangle inequality, so the
+ * bound is admissible and consistent; it is also cheaper than a haversine (one sqrt).
+ * It is scaled down by a tiny factor so floating-point rounding cannot break consistency.
+ */
+template <class T>
+class GeometricBound {
+public:
+    GeometricBound(const CompactGraph<T>& graph, int profile);
+
+    // false without coordinates, or when some edge has zero weight but nonzero length
+    bool isAvailable() const;
+    double getMaxSpeed() const; // meters per weight unit
+    double lowerBound(int v, int target) const;
+
+protected:
+    bool available = false;
+    double maxSpeed = 0;
+    double scale = 0; // 1 / maxSpeed, shrunk for rounding
+    std::vector<double> points; // x, y, z per vertex, in meters
+};
+
+/************************* GeometricBound  **************************/
+
+template <class T>
+GeometricBound<T>::GeometricBound(const CompactGraph<T>& graph, int profile) {
+    if (!graph.hasCoordinates()) return;
+
+    const std::vector<double>& weights = graph.getWeights(profile);
+    for (int e = 0; e < graph.getNumEdges(); e++) {
+        double w = weights[e];
+        if (w == INF) continue;
+        int u = graph.getTail(e), v = graph.getHead(e);
+        double length = haversineDistance(graph.getLatitude(u), graph.getLongitude(u),
+                                          graph.getLatitude(v), graph.getLongitude(v));
+        if (length == 0) continue;
+        if (w <= 0) return; // infinitely fast edge, no useful bound
+        maxSpeed = std::max(maxSpeed, length / w);
+    }
+    if (maxSpeed == 0) return; // no edge with length, the bound would be 0 everywhere
+
+    const double toRad = M_PI / 180.0;
+    points.reserve(3 * graph.getNumVertex());
+    for (int v = 0; v < graph.getNumVertex(); v++) {
+        double lat = graph.getLatitude(v) * toRad, lon = graph.getLongitude(v) * toRad;
+        points.push_back(EARTH_RADIUS * std::cos(lat) * std::cos(lon));
+        points.push_back(EARTH_RADIUS * std::cos(lat) * std::sin(lon));
+        points.push_back(EARTH_RADIUS * std::sin(lat));
+    }
+    scale = (1 - 1e-9) / maxSpeed;
+    available = true;
+}
+
+template <class T>
+bool GeometricBound<T>::isAvailable() const {
+    return available;
+}
+
+template <class T>
+double GeometricBound<T>::getMaxSpeed() const {
+    return maxSpeed;
+}
+
+template <class T>
+double GeometricBound<T>::lowerBound(int v, int target) const {
+    const double* a = &points[3 * v];
+    const double* b = &points[3 * target];
+    double dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+    return std::sqrt(dx * dx + dy * dy + dz * dz) * scale;
+}
+
+/*
+ * Unified point-to-point search: A* with the geometric bound when it is available
+ * for the profile, plain Dijkstra otherwise.
+ */
+template <class T>
+double fastestPath(const CompactGraph<T>& graph, int profile, const GeometricBound<T>& bound,
+                   int source, int target, SearchWorkspace& ws) {
+    const std::vector<double>& weights = graph.getWeights(profile);
+    if (!bound.isAvailable()) return shortestPath(graph, weights, source, target, ws);
+    return shortestPath(graph, weights, source, target, ws, [&](int v) { return bound.lowerBound(v, target); });
+}
+
+#endif
@@ -31,6 +31,10 @@ public:
     bool isVisited() const;
     bool isProcessing() const;
     bool hasParking() const;
+    const std::vector<std::string>& getTags() const;
+    bool hasCoordinates() const;
+    double getLatitude() const;
+    double getLongitude() const;
     bool isAvailable() const;
     unsigned int getIndegree() const;
     double getDist() const;
@@ -43,6 +47,8 @@ public:
     void setVisited(bool visited);
     void setProcessing(bool processing);
     void setParking(bool parking);
+    void addTag(const std::string& tag);
+    void setCoordinates(double latitude, double longitude);
 
     int getLow() const;
     void setLow(int value);
@@ -65,6 +71,9 @@ protected:
     bool visited = false; // used by DFS, BFS, Primm
     bool processing = false; // used to detect cycles
     bool parkingSpace = false;
+    std::vector<std::string> tags; // point-of-interest categories (hospital, school, ...)
+    bool coordinates = false; // latitude and longitude are optional in Locations.csv
+    double latitude = 0, longitude = 0;
     bool available = true;
     
     int low = -1, num = -1; // used by SCC Tarjan
@@ -285,6 +294,26 @@ bool Vertex<T>::hasParking() const {
     return this->parkingSpace;
 }
 
+template <class T>
+const std::vector<std::string>& Vertex<T>::getTags() const {
+    return this->tags;
+}
+
+template <class T>
+bool Vertex<T>::hasCoordinates() const {
+    return this->coordinates;
+}
+
+template <class T>
+double Vertex<T>::getLatitude() const {
+    return this->latitude;
+}
+
+template <class T>
+double Vertex<T>::getLongitude() const {
+    return this->longitude;
+}
+
 template <class T>
 unsigned int Vertex<T>::getIndegree() const {
     return this->indegree;
@@ -325,6 +354,18 @@ void Vertex<T>::setParking(bool parking) {
     this->parkingSpace = parking;
 }
 
+template <class T>
+void Vertex<T>::addTag(const std::string& tag) {
+    if (std::find(tags.begin(), tags.end(), tag) == tags.end()) tags.push_back(tag);
+}
+
+template <class T>
+void Vertex<T>::setCoordinates(double latitude, double longitude) {
+    this->latitude = latitude;
+    this->longitude = longitude;
+    this->coordinates = true;
+}
+
 template <class T>
 void Vertex<T>::setIndegree(unsigned int indegree) {
     this->indegree = indegree;
@@ -0,0 +1,148 @@
+#ifndef ISOCHRONE_HPP
+#define ISOCHRONE_HPP
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "compactgraph.hpp"
+#include "parallel.hpp"
+#include "search.hpp"
+
+/******************** CompactBitset ********************/
+
+/*
+ * Fixed-size set of vertex indices, one bit per vertex.
+ */
+class CompactBitset {
+public:
+    explicit CompactBitset(int size = 0);
+
+    int size() const;
+    bool test(int i) const;
+    void set(int i);
+    int count() const;
+    // calls fn(i) for every member, in increasing order
+    template <class F>
+    void forEach(F fn) const;
+
+protected:
+    int bits;
+    std::vector<uint64_t> words;
+};
+
+/******************** Isochrone ********************/
+
+enum IsochroneMode { ISOCHRONE_DRIVING, ISOCHRONE_WALKING, ISOCHRONE_DRIVING_WALKING };
+
+// edge leaving the isochrone: only the first 'fraction' of it can be covered in time
+struct BoundaryEdge {
+    int edge;
+    double fraction;
+};
+
+struct Isochrone {
+    CompactBitset reached;
+    std::vector<BoundaryEdge> boundary;
+};
+
+/*
+ * Every vertex reachable from origin within maxTime, plus the partially covered
+ * edges on the border. Bounded Dijkstra on the driving or walking weights; for
+ * ISOCHRONE_DRIVING_WALKING the driving tree is bounded first and every parking
+ * vertex it reaches seeds a walking search with its arrival time, so reached
+ * vertices are those one can walk to after parking.
+ * The two workspaces are reused between calls, one pair per thread.
+ */
+template <class T>
+Isochrone computeIsochrone(const CompactGraph<T>& graph, int origin, double maxTime, IsochroneMode mode,
+                           SearchWorkspace& driveWs, SearchWorkspace& walkWs) {
+    if (origin < 0 || origin >= graph.getNumVertex()) {
+        throw std::runtime_error("Isochrone error: invalid origin index " + std::to_string(origin) + "\n");
+    }
+
+    SearchWorkspace* result = &driveWs;
+    int profile = DRIVING;
+    if (mode == ISOCHRONE_WALKING) {
+        profile = WALKING;
+        shortestPathTree(graph, graph.getWeights(WALKING), origin, walkWs, maxTime);
+        result = &walkWs;
+    } else {
+        shortestPathTree(graph, graph.getWeights(DRIVING), origin, driveWs, maxTime);
+    }
+
+    if (mode == ISOCHRONE_DRIVING_WALKING) {
+        std::vector<std::pair<int, double>> seeds;
+        for (int v : driveWs.order) {
+            if (graph.hasParking(v)) seeds.push_back({v, driveWs.dist[v]});
+        }
+        shortestPathTree(graph, graph.getWeights(WALKING), seeds, walkWs, maxTime);
+        result = &walkWs;
+        profile = WALKING;
+    }
+
+    const std::vector<double>& weights = graph.getWeights(profile);
+    Isochrone iso{CompactBitset(graph.getNumVertex()), {}};
+    for (int u : result->order) {
+        iso.reached.set(u);
+        double d = result->dist[u];
+        for (int e = graph.edgesBegin(u); e < graph.edgesEnd(u); e++) {
+            double w = weights[e];
+            if (w == INF || d + w <= maxTime || d == maxTime) continue;
+            int v = graph.getHead(e);
+            // two-way segment already covered by walking/driving in from both ends
+            if (result->settled[v] && (maxTime - d) + (maxTime - result->dist[v]) >= w) continue;
+            iso.boundary.push_back({e, (maxTime - d) / w});
+        }
+    }
+    return iso;
+}
+
+/*
+ * Isochrones for many origins, computed in parallel with one pair of
+ * workspaces per thread.
+ */
+template <class T>
+std::vector<Isochrone> computeIsochrones(const CompactGraph<T>& graph, const std::vector<int>& origins,
+                                         double maxTime, IsochroneMode mode) {
+    unsigned int threads = getThreadCount();
+    std::vector<SearchWorkspace> driveWs(threads), walkWs(threads);
+    std::vector<Isochrone> result(origins.size());
+
+    parallelFor(origins.size(), [&](int i, unsigned int t) {
+        result[i] = computeIsochrone(graph, origins[i], maxTime, mode, driveWs[t], walkWs[t]);
+    }, threads);
+    return result;
+}
+
+/************************* CompactBitset  **************************/
+
+inline CompactBitset::CompactBitset(int size) : bits(size), words((size + 63) / 64, 0) {}
+
+inline int CompactBitset::size() const {
+    return bits;
+}
+
+inline bool CompactBitset::test(int i) const {
+    return (words[i >> 6] >> (i & 63)) & 1;
+}
+
+inline void CompactBitset::set(int i) {
+    words[i >> 6] |= uint64_t(1) << (i & 63);
+}
+
+inline int CompactBitset::count() const {
+    int total = 0;
+    for (uint64_t word : words) total += __builtin_popcountll(word);
+    return total;
+}
+
+template <class F>
+void CompactBitset::forEach(F fn) const {
+    for (size_t w = 0; w < words.size(); w++) {
+        for (uint64_t word = words[w]; word != 0; word &= word - 1) {
+            fn(static_cast<int>(w * 64 + __builtin_ctzll(word)));
+        }
+    }
+}
+
+#endif
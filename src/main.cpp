@@ -12,6 +12,11 @@ void showMenu() {
     std::cout << "4. Calculate route with restrictions (driving)\n";
     std::cout << "5. Calculate environmentally friendly route (driving + walking)\n";
     std::cout << "6. Use batch mode\n";
+    std::cout << "7. Load POIs.csv (points of interest)\n";
+    std::cout << "8. Load GTFS transit feed (data/gtfs)\n";
+    std::cout << "9. Load Turns.csv (turn costs and banned turns)\n";
+    std::cout << "10. Load Profiles.csv (extra vehicle profiles)\n";
+    std::cout << "11. Load Capacities.csv (road capacities)\n";
     std::cout << "0. Exit\n";
     std::cout << "Choose an option: ";
 }
@@ -112,6 +117,21 @@ int main() {
             case 6:
                 handleBatchMode();
                 break;
+            case 7:
+                storageHandler.loadPointsOfInterest("../data/POIs.csv");
+                break;
+            case 8:
+                storageHandler.loadTransitFeed("../data/gtfs");
+                break;
+            case 9:
+                storageHandler.loadTurns("../data/Turns.csv");
+                break;
+            case 10:
+                storageHandler.loadProfiles("../data/Profiles.csv");
+                break;
+            case 11:
+                storageHandler.loadProfiles("../data/Capacities.csv");
+                break;
             case 0:
                 std::cout << "Thank you for using route planner." << std::endl;
                 break;
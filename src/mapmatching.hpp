@@ -0,0 +1,324 @@
+#ifndef MAPMATCHING_HPP
+#define MAPMATCHING_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+#include "compactgraph.hpp"
+#include "parallel.hpp"
+#include "search.hpp"
+#include "spatial.hpp"
+
+struct GpsPoint {
+    double latitude;
+    double longitude;
+};
+
+struct MapMatchingParams {
+    double searchRadius = 50;   // meters around a GPS point where candidate edges are looked up
+    int maxCandidates = 8;      // candidate edges kept per GPS point
+    double gpsSigma = 10;       // standard deviation of the GPS noise, meters
+    double beta = 20;           // scale of the route/straight-line length difference, meters
+    double maxDetourFactor = 4; // route searches stop at this many times the straight distance
+};
+
+struct MatchedTrace {
+    std::vector<int> edges;        // driven edge sequence, consecutive duplicates removed
+    std::vector<EdgeSnap> points;  // chosen position of every GPS point (edge -1 if unmatched)
+    int breaks = 0;                // times the chain had to restart (no feasible transition)
+};
+
+/*
+ * Per-thread state of MapMatcher::match(). Besides the search workspace it keeps the route
+ * searches of the current trace in flat arrays: a small table of source slots, reused least
+ * recently used first, and one row for every vertex any of them reached. The distance and
+ * parent edge from the source of slot s to a vertex are at row * slots + s.
+ */
+struct MatchWorkspace {
+    SearchWorkspace search;
+    int slots = 0;
+    std::vector<int> source;              // per slot, -1 when free
+    std::vector<double> cutoff;           // per slot, radius of its search
+    std::vector<long long> lastUse;       // per slot
+    std::vector<std::vector<int>> filled; // per slot, rows it wrote
+    std::vector<int> row;                 // per vertex, -1 when no cached search reached it
+    std::vector<int> rowVertex;
+    std::vector<double> dist;
+    std::vector<int> parent;
+    long long clock = 0;
+    std::vector<int> routes; // inner edges of the best transition into every state, see match()
+};
+
+/******************** MapMatcher ********************/
+
+/*
+ * Hidden Markov Model map matching (Newson & Krumm):
+ *  - states are the drivable edges near each GPS point, found with the spatial index,
+ *    in both directions of two-way segments;
+ *  - emissions are Gaussian in the distance between the point and its projection;
+ *  - transitions are exponential in the difference between the route length along the
+ *    network and the straight-line distance of consecutive points. Route lengths come from
+ *    bounded searches over the geometric edge lengths, one per distinct source vertex,
+ *    cached per trace since consecutive points often share candidates. A transition only
+ *    searches from the candidates of the previous point, so a cache of twice maxCandidates
+ *    sources always holds them all;
+ *  - the most likely sequence is decoded with Viterbi in log space. The route of the best
+ *    transition into every state is read from the search parents while they are cached,
+ *    so the matched edges need no search of their own.
+ * match() only uses the workspace it is given, so traces can be matched in parallel.
+ */
+template <class T>
+class MapMatcher {
+public:
+    MapMatcher(const CompactGraph<T>& graph, const SpatialIndex<T>& index, MapMatchingParams params = MapMatchingParams());
+
+    MatchedTrace match(const std::vector<GpsPoint>& trace, MatchWorkspace& mw) const;
+    std::vector<MatchedTrace> matchAll(const std::vector<std::vector<GpsPoint>>& traces) const;
+
+protected:
+    const CompactGraph<T>& graph;
+    const SpatialIndex<T>& index;
+    MapMatchingParams params;
+    std::vector<double> lengths;  // meters, INF on edges that cannot be driven
+    std::vector<int> reverseEdge; // opposite direction of a two-way segment, -1 if none
+
+    std::vector<EdgeSnap> candidates(const GpsPoint& point) const;
+    void resetCache(MatchWorkspace& mw) const;
+    int searchFrom(int source, double cutoff, MatchWorkspace& mw) const;
+    double routeLength(const EdgeSnap& from, const EdgeSnap& to, double cutoff, MatchWorkspace& mw) const;
+    void appendRoute(const EdgeSnap& from, const EdgeSnap& to, MatchWorkspace& mw, std::vector<int>& edges) const;
+};
+
+/************************* MapMatcher  **************************/
+
+template <class T>
+MapMatcher<T>::MapMatcher(const CompactGraph<T>& graph, const SpatialIndex<T>& index, MapMatchingParams params)
+    : graph(graph), index(index), params(params) {
+    const std::vector<double>& driving = graph.getWeights(DRIVING);
+    int m = graph.getNumEdges();
+    lengths.resize(m);
+    reverseEdge.assign(m, -1);
+    for (int e = 0; e < m; e++) {
+        int u = graph.getTail(e), v = graph.getHead(e);
+        lengths[e] = driving[e] == INF ? INF : haversineDistance(graph.getLatitude(u), graph.getLongitude(u),
+                                                                 graph.getLatitude(v), graph.getLongitude(v));
+        Edge<T>* reverse = graph.getEdge(e)->getReverse();
+        if (reverse == nullptr) continue;
+        for (int r = graph.edgesBegin(v); r < graph.edgesEnd(v); r++) {
+            if (graph.getEdge(r) == reverse) reverseEdge[e] = r;
+        }
+    }
+}
+
+template <class T>
+std::vector<EdgeSnap> MapMatcher<T>::candidates(const GpsPoint& point) const {
+    std::vector<EdgeSnap> result;
+    for (const EdgeSnap& snap : index.nearestEdges(point.latitude, point.longitude, params.maxCandidates, params.searchRadius)) {
+        if (lengths[snap.edge] != INF) result.push_back(snap);
+        int reverse = reverseEdge[snap.edge];
+        if (reverse != -1 && lengths[reverse] != INF) result.push_back({reverse, 1 - snap.fraction, snap.distance});
+    }
+    return result;
+}
+
+template <class T>
+void MapMatcher<T>::resetCache(MatchWorkspace& mw) const {
+    mw.slots = 2 * params.maxCandidates;
+    mw.source.assign(mw.slots, -1);
+    mw.cutoff.assign(mw.slots, -1);
+    mw.lastUse.assign(mw.slots, 0);
+    mw.filled.resize(mw.slots);
+    for (std::vector<int>& rows : mw.filled) rows.clear();
+    mw.row.resize(graph.getNumVertex(), -1);
+    for (int v : mw.rowVertex) mw.row[v] = -1;
+    mw.rowVertex.clear();
+    mw.dist.clear();
+    mw.parent.clear();
+    mw.routes.clear();
+}
+
+/*
+ * Slot holding a search from source that reaches at least cutoff, searching again in the
+ * slot used longest ago when there is none.
+ */
+template <class T>
+int MapMatcher<T>::searchFrom(int source, double cutoff, MatchWorkspace& mw) const {
+    int slot = -1;
+    for (int s = 0; s < mw.slots; s++) {
+        if (mw.source[s] == source) {
+            slot = s;
+            break;
+        }
+        if (slot == -1 || mw.lastUse[s] < mw.lastUse[slot]) slot = s;
+    }
+    mw.lastUse[slot] = ++mw.clock;
+    if (mw.source[slot] == source && mw.cutoff[slot] >= cutoff) return slot;
+
+    for (int r : mw.filled[slot]) {
+        mw.dist[static_cast<size_t>(r) * mw.slots + slot] = INF;
+        mw.parent[static_cast<size_t>(r) * mw.slots + slot] = -1;
+    }
+    mw.filled[slot].clear();
+    mw.source[slot] = source;
+    mw.cutoff[slot] = cutoff;
+
+    shortestPathTree(graph, lengths, source, mw.search, cutoff);
+    for (int v : mw.search.order) {
+        if (mw.row[v] == -1) {
+            mw.row[v] = mw.rowVertex.size();
+            mw.rowVertex.push_back(v);
+            mw.dist.resize(mw.dist.size() + mw.slots, INF);
+            mw.parent.resize(mw.parent.size() + mw.slots, -1);
+        }
+        size_t at = static_cast<size_t>(mw.row[v]) * mw.slots + slot;
+        mw.dist[at] = mw.search.dist[v];
+        mw.parent[at] = mw.search.parent[v];
+        mw.filled[slot].push_back(mw.row[v]);
+    }
+    return slot;
+}
+
+/*
+ * Network distance in meters between two snapped positions, INF beyond the cutoff.
+ */
+template <class T>
+double MapMatcher<T>::routeLength(const EdgeSnap& from, const EdgeSnap& to, double cutoff, MatchWorkspace& mw) const {
+    if (from.edge == to.edge && to.fraction >= from.fraction) {
+        return (to.fraction - from.fraction) * lengths[from.edge];
+    }
+
+    double head = (1 - from.fraction) * lengths[from.edge];
+    double tail = to.fraction * lengths[to.edge];
+    double remaining = cutoff - head - tail;
+    if (remaining < 0) return INF;
+
+    // searched up to the farthest any target could need, so other targets reuse it
+    int slot = searchFrom(graph.getHead(from.edge), cutoff - head, mw);
+    int r = mw.row[graph.getTail(to.edge)];
+    if (r == -1) return INF;
+    double d = mw.dist[static_cast<size_t>(r) * mw.slots + slot];
+    return d > remaining ? INF : head + d + tail;
+}
+
+/*
+ * Appends the edges between two snapped positions, excluding their own, following the parents
+ * of a search routeLength() has just cached for this pair.
+ */
+template <class T>
+void MapMatcher<T>::appendRoute(const EdgeSnap& from, const EdgeSnap& to, MatchWorkspace& mw, std::vector<int>& edges) const {
+    if (from.edge == to.edge && to.fraction >= from.fraction) return;
+    int source = graph.getHead(from.edge);
+    int slot = 0;
+    while (mw.source[slot] != source) slot++;
+
+    size_t first = edges.size();
+    for (int v = graph.getTail(to.edge); v != source;) {
+        int e = mw.parent[static_cast<size_t>(mw.row[v]) * mw.slots + slot];
+        edges.push_back(e);
+        v = graph.getTail(e);
+    }
+    std::reverse(edges.begin() + first, edges.end());
+}
+
+template <class T>
+MatchedTrace MapMatcher<T>::match(const std::vector<GpsPoint>& trace, MatchWorkspace& mw) const {
+    MatchedTrace result;
+    int n = trace.size();
+    result.points.assign(n, EdgeSnap{-1, 0, INF});
+
+    std::vector<std::vector<EdgeSnap>> states(n);
+    std::vector<std::vector<double>> score(n);
+    std::vector<std::vector<int>> back(n);
+    std::vector<std::vector<std::pair<int, int>>> route(n); // [first, last) of mw.routes
+    resetCache(mw);
+
+    auto emission = [&](const EdgeSnap& snap) {
+        double z = snap.distance / params.gpsSigma;
+        return -0.5 * z * z;
+    };
+
+    int previous = -1; // last point with candidates
+    for (int i = 0; i < n; i++) {
+        states[i] = candidates(trace[i]);
+        score[i].assign(states[i].size(), -INF);
+        back[i].assign(states[i].size(), -1);
+        route[i].assign(states[i].size(), {0, 0});
+        if (states[i].empty()) continue;
+
+        bool connected = false;
+        if (previous != -1) {
+            double straight = haversineDistance(trace[previous].latitude, trace[previous].longitude,
+                                                trace[i].latitude, trace[i].longitude);
+            double cutoff = params.maxDetourFactor * straight + 2 * params.searchRadius;
+            for (size_t b = 0; b < states[i].size(); b++) {
+                for (size_t a = 0; a < states[previous].size(); a++) {
+                    if (score[previous][a] == -INF) continue;
+                    double length = routeLength(states[previous][a], states[i][b], cutoff, mw);
+                    if (length == INF) continue;
+                    double candidate = score[previous][a] - std::abs(length - straight) / params.beta;
+                    if (candidate > score[i][b]) {
+                        score[i][b] = candidate;
+                        back[i][b] = a;
+                    }
+                }
+                if (score[i][b] != -INF) {
+                    score[i][b] += emission(states[i][b]);
+                    connected = true;
+                    int first = mw.routes.size();
+                    appendRoute(states[previous][back[i][b]], states[i][b], mw, mw.routes);
+                    route[i][b] = {first, static_cast<int>(mw.routes.size())};
+                }
+            }
+        }
+
+        if (!connected) {
+            // start (or restart) the chain at this point
+            if (previous != -1) result.breaks++;
+            for (size_t b = 0; b < states[i].size(); b++) {
+                score[i][b] = emission(states[i][b]);
+                back[i][b] = -1;
+            }
+        }
+        previous = i;
+    }
+
+    // backtrack from the best final state, following restarts as new chains
+    std::vector<int> chosen(n, -1);
+    int state = -1;
+    for (int i = n - 1; i >= 0; i--) {
+        if (states[i].empty()) continue;
+        if (state == -1) {
+            state = 0;
+            for (size_t b = 1; b < states[i].size(); b++) {
+                if (score[i][b] > score[i][state]) state = b;
+            }
+        }
+        chosen[i] = state;
+        state = back[i][state];
+    }
+
+    auto push = [&](int e) { if (result.edges.empty() || result.edges.back() != e) result.edges.push_back(e); };
+    for (int i = 0; i < n; i++) {
+        if (chosen[i] == -1) continue;
+        result.points[i] = states[i][chosen[i]];
+        // a transition starts on the edge of the previous chosen state, pushed already
+        auto [first, last] = route[i][chosen[i]];
+        for (int k = first; k < last; k++) push(mw.routes[k]);
+        push(result.points[i].edge);
+    }
+    return result;
+}
+
+template <class T>
+std::vector<MatchedTrace> MapMatcher<T>::matchAll(const std::vector<std::vector<GpsPoint>>& traces) const {
+    unsigned int threads = getThreadCount();
+    std::vector<MatchWorkspace> mw(threads);
+    std::vector<MatchedTrace> result(traces.size());
+    parallelFor(traces.size(), [&](int i, unsigned int t) {
+        result[i] = match(traces[i], mw[t]);
+    }, threads);
+    return result;
+}
+
+#endif
@@ -0,0 +1,283 @@
+#ifndef MAXFLOW_HPP
+#define MAXFLOW_HPP
+
+#include <algorithm>
+#include <queue>
+#include <string>
+#include <vector>
+#include "compactgraph.hpp"
+#include "parallel.hpp"
+
+// weight column holding the road capacities (e.g. vehicles per hour)
+const std::string CAPACITY_COLUMN = "capacity";
+
+struct FlowQuery {
+    std::vector<int> sources; // snapshot indices of the zone the flow leaves from
+    std::vector<int> sinks;   // and of the zone it must reach
+};
+
+struct MaxFlowResult {
+    double value = 0;
+    std::vector<double> flow; // per edge, in its own direction
+    std::vector<int> cut;     // saturated edges from the source side to the sink side of a minimum cut
+};
+
+/******************** MaxFlow ********************/
+
+/*
+ * Maximum flow between two zones of the snapshot, by FIFO push-relabel.
+ *  - Each edge is an arc of the residual graph; its Edge::reverse twin (the other direction of a
+ *    two-way road) is its residual pair, so flow over a two-way road is kept as one net amount,
+ *    and one-way roads get a zero-capacity twin.
+ *  - Global relabeling sets exact heights by a backward BFS from the sinks (and from the
+ *    sources for vertices cut off from the sinks) at the start and after every n relabels.
+ *  - The gap heuristic lifts every vertex above an emptied height below n straight to n + 1,
+ *    since none of them can reach a sink any more.
+ * Capacities of INF mark roads that cannot be used, as in every weight column, and count as 0.
+ * The arcs are read-only once built, so independent zone queries run in parallel (maxFlows).
+ */
+template <class T>
+class MaxFlow {
+public:
+    MaxFlow(const CompactGraph<T>& graph, const std::vector<double>& capacities);
+
+    MaxFlowResult run(const FlowQuery& query) const;
+    std::vector<MaxFlowResult> maxFlows(const std::vector<FlowQuery>& queries) const;
+
+protected:
+    const CompactGraph<T>& graph;
+    // arcs grouped by tail: [arcsBegin[v], arcsBegin[v + 1])
+    std::vector<int> arcsBegin, arcHead, arcPair, arcEdge; // arcEdge -1 for added twins
+    std::vector<double> arcCapacity;
+    std::vector<int> edgeArc;
+
+    void globalRelabel(const std::vector<double>& residual, const std::vector<char>& isSource,
+                       const std::vector<char>& isSink, std::vector<int>& height, std::vector<int>& count) const;
+};
+
+/************************* MaxFlow  **************************/
+
+const double FLOW_EPSILON = 1e-9;
+
+template <class T>
+MaxFlow<T>::MaxFlow(const CompactGraph<T>& graph, const std::vector<double>& capacities) : graph(graph) {
+    int n = graph.getNumVertex(), m = graph.getNumEdges();
+
+    // twin of every edge: its reverse road if there is one, otherwise a new zero-capacity arc
+    std::vector<int> twin(m, -1);
+    for (int e = 0; e < m; e++) {
+        Edge<T>* reverse = graph.getEdge(e)->getReverse();
+        if (reverse == nullptr) continue;
+        int v = graph.getHead(e);
+        for (int r = graph.edgesBegin(v); r < graph.edgesEnd(v); r++) {
+            if (graph.getEdge(r) == reverse && graph.getHead(r) == graph.getTail(e)) twin[e] = r;
+        }
+    }
+
+    std::vector<int> tail, head, edge;
+    for (int e = 0; e < m; e++) {
+        tail.push_back(graph.getTail(e));
+        head.push_back(graph.getHead(e));
+        edge.push_back(e);
+    }
+    std::vector<int> pair(m);
+    for (int e = 0; e < m; e++) {
+        if (twin[e] != -1) {
+            pair[e] = twin[e];
+        } else {
+            pair[e] = tail.size();
+            pair.push_back(e);
+            tail.push_back(graph.getHead(e));
+            head.push_back(graph.getTail(e));
+            edge.push_back(-1);
+        }
+    }
+
+    // counting sort of the arcs by tail
+    int arcs = tail.size();
+    arcsBegin.assign(n + 1, 0);
+    for (int a = 0; a < arcs; a++) arcsBegin[tail[a] + 1]++;
+    for (int v = 0; v < n; v++) arcsBegin[v + 1] += arcsBegin[v];
+    std::vector<int> position(arcs), fill(arcsBegin.begin(), arcsBegin.end() - 1);
+    for (int a = 0; a < arcs; a++) position[a] = fill[tail[a]]++;
+
+    arcHead.resize(arcs);
+    arcPair.resize(arcs);
+    arcEdge.resize(arcs);
+    arcCapacity.resize(arcs);
+    edgeArc.resize(m);
+    for (int a = 0; a < arcs; a++) {
+        int p = position[a];
+        arcHead[p] = head[a];
+        arcPair[p] = position[pair[a]];
+        arcEdge[p] = edge[a];
+        double capacity = edge[a] == -1 ? 0 : capacities[edge[a]];
+        arcCapacity[p] = capacity == INF ? 0 : capacity;
+        if (edge[a] != -1) edgeArc[edge[a]] = p;
+    }
+}
+
+template <class T>
+void MaxFlow<T>::globalRelabel(const std::vector<double>& residual, const std::vector<char>& isSource,
+                               const std::vector<char>& isSink, std::vector<int>& height, std::vector<int>& count) const {
+    int n = graph.getNumVertex();
+    std::fill(height.begin(), height.end(), -1);
+    std::fill(count.begin(), count.end(), 0);
+
+    // BFS over residual arcs, walked backwards: v gets a height if some arc v -> u has room
+    auto bfs = [&](const std::vector<char>& roots, int base) {
+        std::queue<int> queue;
+        for (int v = 0; v < n; v++) {
+            if (roots[v]) {
+                height[v] = base;
+                queue.push(v);
+            }
+        }
+        while (!queue.empty()) {
+            int u = queue.front();
+            queue.pop();
+            for (int a = arcsBegin[u]; a < arcsBegin[u + 1]; a++) {
+                int v = arcHead[a];
+                if (height[v] != -1 || residual[arcPair[a]] <= FLOW_EPSILON) continue;
+                height[v] = height[u] + 1;
+                queue.push(v);
+            }
+        }
+    };
+    for (int v = 0; v < n; v++) {
+        if (isSource[v]) height[v] = n; // the sink BFS must not pass through the sources
+    }
+    bfs(isSink, 0);
+    bfs(isSource, n);
+    for (int v = 0; v < n; v++) {
+        if (height[v] == -1) height[v] = 2 * n; // can reach neither zone, holds no excess
+        if (height[v] < 2 * n) count[height[v]]++;
+    }
+}
+
+template <class T>
+MaxFlowResult MaxFlow<T>::run(const FlowQuery& query) const {
+    int n = graph.getNumVertex(), m = graph.getNumEdges();
+    MaxFlowResult result;
+    result.flow.assign(m, 0);
+
+    std::vector<char> isSource(n, false), isSink(n, false);
+    for (int v : query.sources) isSource[v] = true;
+    for (int v : query.sinks) {
+        if (!isSource[v]) isSink[v] = true;
+    }
+
+    std::vector<double> residual = arcCapacity, excess(n, 0);
+    std::vector<int> height(n), count(2 * n + 1), current(n);
+    std::queue<int> active;
+    for (int v = 0; v < n; v++) current[v] = arcsBegin[v];
+
+    auto push = [&](int u, int a, double amount) {
+        int v = arcHead[a];
+        residual[a] -= amount;
+        residual[arcPair[a]] += amount;
+        excess[u] -= amount;
+        if (excess[v] <= FLOW_EPSILON && !isSource[v] && !isSink[v]) active.push(v);
+        excess[v] += amount;
+    };
+
+    // saturate every arc leaving the source zone
+    for (int s : query.sources) {
+        for (int a = arcsBegin[s]; a < arcsBegin[s + 1]; a++) {
+            if (residual[a] > FLOW_EPSILON && !isSource[arcHead[a]]) {
+                excess[s] += residual[a];
+                push(s, a, residual[a]);
+            }
+        }
+    }
+    globalRelabel(residual, isSource, isSink, height, count);
+
+    int relabels = 0;
+    while (!active.empty()) {
+        int u = active.front();
+        active.pop();
+        if (height[u] >= 2 * n) continue;
+
+        while (excess[u] > FLOW_EPSILON) {
+            if (current[u] == arcsBegin[u + 1]) {
+                // relabel to one above the lowest neighbour with residual room
+                int old = height[u], lowest = 2 * n;
+                for (int a = arcsBegin[u]; a < arcsBegin[u + 1]; a++) {
+                    if (residual[a] > FLOW_EPSILON) lowest = std::min(lowest, height[arcHead[a]] + 1);
+                }
+                current[u] = arcsBegin[u];
+                count[old]--;
+                height[u] = lowest;
+                if (lowest < 2 * n) count[lowest]++;
+                relabels++;
+
+                // gap: nothing is left at height old, so whatever sits between it and n is cut off
+                if (old < n && count[old] == 0) {
+                    for (int v = 0; v < n; v++) {
+                        if (height[v] > old && height[v] < n && !isSource[v]) {
+                            count[height[v]]--;
+                            height[v] = n + 1;
+                            count[n + 1]++;
+                            current[v] = arcsBegin[v];
+                        }
+                    }
+                }
+                if (relabels % n == 0) {
+                    globalRelabel(residual, isSource, isSink, height, count);
+                    for (int v = 0; v < n; v++) current[v] = arcsBegin[v];
+                }
+                if (height[u] >= 2 * n) break;
+                continue;
+            }
+
+            int a = current[u];
+            if (residual[a] > FLOW_EPSILON && height[u] == height[arcHead[a]] + 1) {
+                push(u, a, std::min(excess[u], residual[a]));
+            } else {
+                current[u]++;
+            }
+        }
+    }
+
+    for (int v = 0; v < n; v++) {
+        if (isSink[v]) result.value += excess[v];
+    }
+    for (int e = 0; e < m; e++) {
+        int a = edgeArc[e];
+        result.flow[e] = std::max(0.0, arcCapacity[a] - residual[a]);
+    }
+
+    // source side of a minimum cut: what the sources still reach in the residual graph
+    std::vector<char> reached(n, false);
+    std::queue<int> queue;
+    for (int s : query.sources) {
+        reached[s] = true;
+        queue.push(s);
+    }
+    while (!queue.empty()) {
+        int u = queue.front();
+        queue.pop();
+        for (int a = arcsBegin[u]; a < arcsBegin[u + 1]; a++) {
+            int v = arcHead[a];
+            if (!reached[v] && residual[a] > FLOW_EPSILON) {
+                reached[v] = true;
+                queue.push(v);
+            }
+        }
+    }
+    for (int e = 0; e < m; e++) {
+        if (reached[graph.getTail(e)] && !reached[graph.getHead(e)] && arcCapacity[edgeArc[e]] > 0) result.cut.push_back(e);
+    }
+    return result;
+}
+
+template <class T>
+std::vector<MaxFlowResult> MaxFlow<T>::maxFlows(const std::vector<FlowQuery>& queries) const {
+    std::vector<MaxFlowResult> results(queries.size());
+    parallelFor(queries.size(), [&](int i, unsigned int) {
+        results[i] = run(queries[i]);
+    });
+    return results;
+}
+
+#endif
@@ -0,0 +1,158 @@
+#ifndef MEETINGPOINT_HPP
+#define MEETINGPOINT_HPP
+
+#include <algorithm>
+#include <vector>
+#include "compactgraph.hpp"
+#include "search.hpp"
+
+enum MeetingObjective { MEETING_SUM, MEETING_MAX };
+
+struct Participant {
+    int vertex;  // snapshot index where the participant starts
+    int profile; // weight column they travel with
+};
+
+struct MeetingPoint {
+    int vertex = -1;          // -1 when no vertex is reachable by everyone
+    double cost = INF;        // total or maximum travel time
+    std::vector<double> times; // travel time of each participant
+    int settled = 0;          // vertices settled over all searches
+};
+
+/******************** MeetingPointEngine ********************/
+
+/*
+ * Best meeting vertex for N participants, minimising the sum or the maximum of their
+ * travel times. One Dijkstra per participant (each with its own profile) runs forward from
+ * their start, interleaved so that the search with the smallest frontier radius r_i always
+ * goes next. A vertex settled by every search has an exact cost; a vertex some search i has
+ * not settled yet costs at least r_i for that participant, which gives the lower bounds:
+ *  - untouched vertices cost at least sum(r_i) (or max(r_i));
+ *  - partially settled ones at least the known times plus r_i of the missing searches.
+ * The searches stop once no bound is below the best complete vertex. The partially settled
+ * vertices are rescanned only after as many settles as there are of them, so checking the
+ * bound costs O(1) amortised per settle.
+ */
+template <class T>
+class MeetingPointEngine {
+public:
+    explicit MeetingPointEngine(const CompactGraph<T>& graph);
+
+    MeetingPoint find(const std::vector<Participant>& participants, MeetingObjective objective);
+
+protected:
+    const CompactGraph<T>& graph;
+    std::vector<SearchWorkspace> ws;
+    std::vector<int> settledBy; // per vertex, searches that settled it
+    std::vector<int> seen;      // vertices with settledBy > 0
+
+    double combine(double cost, double time, MeetingObjective objective) const;
+};
+
+/************************* MeetingPointEngine  **************************/
+
+template <class T>
+MeetingPointEngine<T>::MeetingPointEngine(const CompactGraph<T>& graph)
+    : graph(graph), settledBy(graph.getNumVertex(), 0) {}
+
+template <class T>
+double MeetingPointEngine<T>::combine(double cost, double time, MeetingObjective objective) const {
+    if (time == INF || cost == INF) return INF;
+    return objective == MEETING_SUM ? cost + time : std::max(cost, time);
+}
+
+template <class T>
+MeetingPoint MeetingPointEngine<T>::find(const std::vector<Participant>& participants, MeetingObjective objective) {
+    int k = participants.size();
+    int n = graph.getNumVertex();
+    MeetingPoint result;
+    if (k == 0) return result;
+
+    if (static_cast<int>(ws.size()) < k) ws.resize(k);
+    std::vector<SearchQueue> queues(k);
+    for (int i = 0; i < k; i++) {
+        ws[i].resize(n);
+        ws[i].reset();
+        ws[i].reach(participants[i].vertex, 0, -1);
+        queues[i].push({0, participants[i].vertex});
+    }
+    for (int v : seen) settledBy[v] = 0;
+    seen.clear();
+
+    // radius of search i: key of its next vertex, INF once it is exhausted
+    auto radius = [&](int i) {
+        SearchQueue& pq = queues[i];
+        while (!pq.empty() && (ws[i].settled[pq.top().second] || pq.top().first > ws[i].dist[pq.top().second])) pq.pop();
+        return pq.empty() ? INF : pq.top().first;
+    };
+    // lower bound on the cost of v given the radii
+    auto lowerBound = [&](int v, const std::vector<double>& radii) {
+        double bound = 0;
+        for (int i = 0; i < k && bound != INF; i++) {
+            bound = combine(bound, ws[i].settled[v] ? ws[i].dist[v] : radii[i], objective);
+        }
+        return bound;
+    };
+
+    std::vector<double> radii(k);
+    long long nextScan = 0; // settles before the partially settled vertices are checked again
+    while (true) {
+        int next = -1;
+        double untouched = 0;
+        for (int i = 0; i < k; i++) {
+            radii[i] = radius(i);
+            untouched = combine(untouched, radii[i], objective);
+            if (radii[i] != INF && (next == -1 || radii[i] < radii[next])) next = i;
+        }
+        if (next == -1) break; // every search is exhausted
+
+        if (untouched >= result.cost && --nextScan <= 0) {
+            bool open = false;
+            for (int v : seen) {
+                if (settledBy[v] < k && lowerBound(v, radii) < result.cost) {
+                    open = true;
+                    break;
+                }
+            }
+            if (!open) break;
+            nextScan = seen.size();
+        }
+
+        // settle one vertex of the chosen search
+        SearchWorkspace& own = ws[next];
+        int u = queues[next].top().second;
+        queues[next].pop();
+        double d = own.dist[u];
+        own.settled[u] = true;
+        own.order.push_back(u);
+        result.settled++;
+
+        if (settledBy[u]++ == 0) seen.push_back(u);
+        if (settledBy[u] == k) {
+            double cost = lowerBound(u, radii); // exact, every search settled u
+            if (cost < result.cost) {
+                result.cost = cost;
+                result.vertex = u;
+            }
+        }
+
+        const std::vector<double>& weights = graph.getWeights(participants[next].profile);
+        for (int e = graph.edgesBegin(u); e < graph.edgesEnd(u); e++) {
+            double w = weights[e];
+            if (w == INF) continue;
+            int v = graph.getHead(e);
+            if (d + w < own.dist[v]) {
+                own.reach(v, d + w, e);
+                queues[next].push({d + w, v});
+            }
+        }
+    }
+
+    if (result.vertex != -1) {
+        for (int i = 0; i < k; i++) result.times.push_back(ws[i].dist[result.vertex]);
+    }
+    return result;
+}
+
+#endif
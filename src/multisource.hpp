@@ -0,0 +1,121 @@
+#ifndef MULTISOURCE_HPP
+#define MULTISOURCE_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "compactgraph.hpp"
+#include "parallel.hpp"
+
+// sources advanced together by one batch, one bit of the frontier masks each
+const int MAX_BATCH_SOURCES = 64;
+
+/*
+ * Computes the distances from up to MAX_BATCH_SOURCES sources at once.
+ * Every vertex holds a small vector with one distance per source ("lane"), stored
+ * contiguously in dist[v * lanes .. v * lanes + lanes). The search is a round-based,
+ * label-correcting relaxation: each round scans the adjacency list of every vertex
+ * that improved in the previous round once. A 64-bit mask per vertex records which lanes
+ * improved, so a vertex is queued at most once per round whatever the number of sources,
+ * and only those lanes are relaxed: the others were already relaxed when they last
+ * improved. A mask with many lanes set is relaxed over all lanes with a branch-free loop
+ * the compiler can vectorise, which is cheaper than walking its bits.
+ */
+template <class T>
+void multiSourceBatch(const CompactGraph<T>& graph, const std::vector<double>& weights,
+                      const int* sources, int lanes, std::vector<double>& dist) {
+    int n = graph.getNumVertex();
+    dist.assign(static_cast<size_t>(n) * lanes, INF);
+
+    std::vector<uint64_t> changed(n, 0);
+    std::vector<int> frontier, nextFrontier;
+
+    for (int l = 0; l < lanes; l++) {
+        int s = sources[l];
+        dist[static_cast<size_t>(s) * lanes + l] = 0;
+        if (changed[s] == 0) frontier.push_back(s);
+        changed[s] |= uint64_t(1) << l;
+    }
+
+    std::vector<uint64_t> nextChanged(n, 0);
+    while (!frontier.empty()) {
+        for (int u : frontier) {
+            uint64_t mask = changed[u];
+            changed[u] = 0;
+            bool dense = __builtin_popcountll(mask) * 4 >= lanes;
+            const double* du = &dist[static_cast<size_t>(u) * lanes];
+            for (int e = graph.edgesBegin(u); e < graph.edgesEnd(u); e++) {
+                double w = weights[e];
+                if (w == INF) continue;
+                int v = graph.getHead(e);
+                double* dv = &dist[static_cast<size_t>(v) * lanes];
+
+                uint64_t improved = 0;
+                if (dense) {
+                    for (int l = 0; l < lanes; l++) {
+                        double cand = du[l] + w;
+                        improved |= static_cast<uint64_t>(cand < dv[l]) << l;
+                        dv[l] = std::min(dv[l], cand);
+                    }
+                } else {
+                    for (uint64_t bits = mask; bits != 0; bits &= bits - 1) {
+                        int l = __builtin_ctzll(bits);
+                        double cand = du[l] + w;
+                        if (cand < dv[l]) {
+                            dv[l] = cand;
+                            improved |= uint64_t(1) << l;
+                        }
+                    }
+                }
+
+                if (improved != 0) {
+                    if (nextChanged[v] == 0) nextFrontier.push_back(v);
+                    nextChanged[v] |= improved;
+                }
+            }
+        }
+
+        frontier.swap(nextFrontier);
+        nextFrontier.clear();
+        changed.swap(nextChanged);
+    }
+}
+
+/*
+ * One-to-all distances from every vertex in 'sources' (vertex indices of the snapshot),
+ * using the given weight column. Sources are processed MAX_BATCH_SOURCES at a time and
+ * the batches run in parallel.
+ * Returns one distance vector per source, indexed by vertex index (INF if unreachable).
+ */
+template <class T>
+std::vector<std::vector<double>> multiSourceDistances(const CompactGraph<T>& graph,
+                                                      const std::vector<int>& sources, int profile) {
+    int n = graph.getNumVertex();
+    for (int s : sources) {
+        if (s < 0 || s >= n) {
+            throw std::runtime_error("Multi-source error: invalid source index " + std::to_string(s) + "\n");
+        }
+    }
+
+    const std::vector<double>& weights = graph.getWeights(profile);
+    std::vector<std::vector<double>> result(sources.size());
+    int batches = (sources.size() + MAX_BATCH_SOURCES - 1) / MAX_BATCH_SOURCES;
+
+    parallelFor(batches, [&](int b, unsigned int) {
+        int first = b * MAX_BATCH_SOURCES;
+        int lanes = std::min<int>(MAX_BATCH_SOURCES, sources.size() - first);
+        std::vector<double> dist;
+        multiSourceBatch(graph, weights, &sources[first], lanes, dist);
+
+        for (int l = 0; l < lanes; l++) {
+            std::vector<double>& row = result[first + l];
+            row.resize(n);
+            for (int v = 0; v < n; v++) row[v] = dist[static_cast<size_t>(v) * lanes + l];
+        }
+    });
+
+    return result;
+}
+
+#endif
@@ -0,0 +1,231 @@
+#ifndef ORACLE_HPP
+#define ORACLE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "compactgraph.hpp"
+#include "parallel.hpp"
+#include "partition.hpp"
+#include "search.hpp"
+
+/*
+ * FNV-1a hash of the structure and one weight column of a snapshot, stored with a saved
+ * oracle so that a file built for other data is never used.
+ */
+template <class T>
+uint64_t graphFingerprint(const CompactGraph<T>& graph, const std::vector<double>& weights) {
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++) hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    };
+    int n = graph.getNumVertex(), m = graph.getNumEdges();
+    mix(&n, sizeof n);
+    mix(&m, sizeof m);
+    for (int e = 0; e < m; e++) {
+        int ends[2] = {graph.getTail(e), graph.getHead(e)};
+        mix(ends, sizeof ends);
+        mix(&weights[e], sizeof(double));
+    }
+    return hash;
+}
+
+/******************** DistanceOracle ********************/
+
+/*
+ * Landmark sketch of one weight column, for cheap travel-time estimates with bounded stretch.
+ *
+ * Every vertex keeps its distance to and from each of k landmarks as floats, rounded up, in one
+ * row of 2k floats, so an estimate reads two rows. The landmarks are the middle of a breadth-first
+ * order of each region of the built-in partitioner, spread over the whole graph.
+ * min over L of d(u, L) + d(L, v) is an upper bound on d(u, v). The landmark triangle inequalities
+ * give a lower bound, max over L of d(L, v) - d(L, u) and d(u, L) - d(v, L). Both are computed
+ * in float and widened by a few epsilons, enough to stay bounds despite the rounding.
+ *
+ * estimate() returns the upper bound when it is within stretch times the lower bound, so the
+ * answer is never more than stretch times the real distance. Otherwise it falls back to an exact
+ * search, which most pairs never need.
+ *
+ * The 2k landmark trees are independent and are built in parallel. save() and load() keep the
+ * sketch in a binary file next to the loaded data, tagged with the graph fingerprint.
+ */
+template <class T>
+class DistanceOracle {
+public:
+    DistanceOracle(const CompactGraph<T>& graph, const std::vector<double>& weights, int landmarks);
+    // reads a saved sketch; false if the file is missing, damaged or made for other data
+    static bool load(const std::string& path, const CompactGraph<T>& graph, const std::vector<double>& weights,
+                     std::unique_ptr<DistanceOracle<T>>& oracle);
+    void save(const std::string& path) const;
+
+    int getLandmarkCount() const;
+    double upperBound(int source, int target) const;
+    double lowerBound(int source, int target) const;
+    // within [d, stretch * d] of the real distance d; ws is only used by fallbacks
+    double estimate(int source, int target, double stretch, SearchWorkspace& ws);
+    int getFallbacks() const; // estimates answered by a search so far
+
+protected:
+    const CompactGraph<T>& graph;
+    const std::vector<double>& weights;
+    int k = 0;
+    std::vector<int> landmarks;
+    std::vector<float> sketch; // per vertex, d(v, L) for every landmark and then d(L, v)
+    int fallbacks = 0;
+
+    DistanceOracle(const CompactGraph<T>& graph, const std::vector<double>& weights);
+    static float roundUp(double d);
+};
+
+/************************* DistanceOracle  **************************/
+
+template <class T>
+DistanceOracle<T>::DistanceOracle(const CompactGraph<T>& graph, const std::vector<double>& weights)
+    : graph(graph), weights(weights) {}
+
+template <class T>
+DistanceOracle<T>::DistanceOracle(const CompactGraph<T>& graph, const std::vector<double>& weights, int count)
+    : graph(graph), weights(weights) {
+    int n = graph.getNumVertex();
+    if (n == 0) return;
+    std::vector<int> region = partitionGraph(graph, count);
+    std::vector<std::vector<int>> members(count);
+    for (int v = 0; v < n; v++) members[region[v]].push_back(v);
+    std::vector<char> state(n, 0);
+    for (const std::vector<int>& vertices : members) {
+        if (vertices.empty()) continue;
+        std::vector<int> order = breadthFirstOrder(graph, vertices, state);
+        for (int v : vertices) state[v] = 0;
+        landmarks.push_back(order[order.size() / 2]);
+    }
+    k = landmarks.size();
+
+    sketch.resize(static_cast<size_t>(n) * 2 * k);
+    unsigned int threads = getThreadCount();
+    std::vector<SearchWorkspace> ws(threads);
+    parallelFor(2 * k, [&](int i, unsigned int t) {
+        bool backward = i >= k;
+        int l = i % k;
+        shortestPathTree(graph, weights, landmarks[l], ws[t], INF, backward);
+        int column = backward ? l : k + l;
+        for (int v = 0; v < n; v++) sketch[static_cast<size_t>(v) * 2 * k + column] = roundUp(ws[t].dist[v]);
+    }, threads);
+}
+
+template <class T>
+float DistanceOracle<T>::roundUp(double d) {
+    if (d == INF) return std::numeric_limits<float>::infinity();
+    float f = static_cast<float>(d);
+    return f < d ? std::nextafter(f, std::numeric_limits<float>::infinity()) : f;
+}
+
+template <class T>
+int DistanceOracle<T>::getLandmarkCount() const {
+    return k;
+}
+
+template <class T>
+int DistanceOracle<T>::getFallbacks() const {
+    return fallbacks;
+}
+
+template <class T>
+double DistanceOracle<T>::upperBound(int source, int target) const {
+    if (source == target) return 0;
+    const float* to = &sketch[static_cast<size_t>(source) * 2 * k];
+    const float* from = &sketch[static_cast<size_t>(target) * 2 * k + k];
+    // four independent accumulators, so the minimums do not wait on each other
+    const float inf = std::numeric_limits<float>::infinity();
+    float b[4] = {inf, inf, inf, inf};
+    int l = 0;
+    for (; l + 4 <= k; l += 4) {
+        for (int i = 0; i < 4; i++) b[i] = std::min(b[i], to[l + i] + from[l + i]);
+    }
+    for (; l < k; l++) b[0] = std::min(b[0], to[l] + from[l]);
+    float best = std::min(std::min(b[0], b[1]), std::min(b[2], b[3]));
+    if (best == std::numeric_limits<float>::infinity()) return INF;
+    return best * (1 + static_cast<double>(std::numeric_limits<float>::epsilon())); // covers the float sum
+}
+
+template <class T>
+double DistanceOracle<T>::lowerBound(int source, int target) const {
+    const float* sTo = &sketch[static_cast<size_t>(source) * 2 * k];
+    const float* tTo = &sketch[static_cast<size_t>(target) * 2 * k];
+    const float* s = sTo + k;
+    const float* t = tTo + k;
+    // 4 epsilons of the larger term cover both the rounding up and the float arithmetic
+    const float shrink = 1 - 4 * std::numeric_limits<float>::epsilon();
+    // unreachable landmarks give inf - inf, which std::max skips
+    float b[4] = {0, 0, 0, 0};
+    int l = 0;
+    for (; l + 4 <= k; l += 4) {
+        for (int i = 0; i < 4; i++) b[i] = std::max(std::max(b[i], t[l + i] * shrink - s[l + i]), sTo[l + i] * shrink - tTo[l + i]);
+    }
+    for (; l < k; l++) b[0] = std::max(std::max(b[0], t[l] * shrink - s[l]), sTo[l] * shrink - tTo[l]);
+    float best = std::max(std::max(b[0], b[1]), std::max(b[2], b[3]));
+    return best == std::numeric_limits<float>::infinity() ? INF : best;
+}
+
+template <class T>
+double DistanceOracle<T>::estimate(int source, int target, double stretch, SearchWorkspace& ws) {
+    double upper = upperBound(source, target);
+    double lower = lowerBound(source, target);
+    if (lower == INF) return INF;
+    if (upper != INF && upper <= stretch * lower) return upper;
+    fallbacks++;
+    return shortestPath(graph, weights, source, target, ws);
+}
+
+template <class T>
+void DistanceOracle<T>::save(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not write distance oracle file " + path);
+    }
+    uint64_t fingerprint = graphFingerprint(graph, weights);
+    int n = graph.getNumVertex();
+    file.write("RPO2", 4);
+    file.write(reinterpret_cast<const char*>(&fingerprint), sizeof fingerprint);
+    file.write(reinterpret_cast<const char*>(&n), sizeof n);
+    file.write(reinterpret_cast<const char*>(&k), sizeof k);
+    file.write(reinterpret_cast<const char*>(landmarks.data()), landmarks.size() * sizeof(int));
+    file.write(reinterpret_cast<const char*>(sketch.data()), sketch.size() * sizeof(float));
+}
+
+template <class T>
+bool DistanceOracle<T>::load(const std::string& path, const CompactGraph<T>& graph, const std::vector<double>& weights,
+                             std::unique_ptr<DistanceOracle<T>>& oracle) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    char magic[4];
+    uint64_t fingerprint;
+    int n, k;
+    file.read(magic, 4);
+    file.read(reinterpret_cast<char*>(&fingerprint), sizeof fingerprint);
+    file.read(reinterpret_cast<char*>(&n), sizeof n);
+    file.read(reinterpret_cast<char*>(&k), sizeof k);
+    if (!file || std::memcmp(magic, "RPO2", 4) != 0 || n != graph.getNumVertex() || k < 0 || k > n
+        || fingerprint != graphFingerprint(graph, weights)) {
+        return false;
+    }
+
+    std::unique_ptr<DistanceOracle<T>> result(new DistanceOracle<T>(graph, weights));
+    result->k = k;
+    result->landmarks.resize(k);
+    result->sketch.resize(static_cast<size_t>(n) * 2 * k);
+    file.read(reinterpret_cast<char*>(result->landmarks.data()), k * sizeof(int));
+    file.read(reinterpret_cast<char*>(result->sketch.data()), result->sketch.size() * sizeof(float));
+    if (!file) return false;
+    oracle = std::move(result);
+    return true;
+}
+
+#endif
@@ -0,0 +1,352 @@
+#ifndef OVERLAY_HPP
+#define OVERLAY_HPP
+
+#include <algorithm>
+#include <vector>
+#include "compactgraph.hpp"
+#include "parallel.hpp"
+#include "partition.hpp"
+#include "search.hpp"
+
+/******************** OverlayGraph ********************/
+
+/*
+ * Metric-independent part of Customizable Route Planning: a nested multi-level partition and
+ * the boundary vertices of every cell.
+ * The partitioner's bisection order makes the regions nest: with levels * bitsPerLevel bits of
+ * regions, the level l cell of v (l = 1 is the finest) is region(v) >> (bitsPerLevel * (l - 1)).
+ * A vertex is a boundary vertex of its level l cell when one of its edges (either way) leaves
+ * that cell; boundaries of coarser levels are subsets of the finer ones.
+ */
+template <class T>
+class OverlayGraph {
+public:
+    OverlayGraph(const CompactGraph<T>& graph, int levels, int bitsPerLevel);
+
+    const CompactGraph<T>& getGraph() const;
+    int getLevels() const;
+    int getCellCount(int level) const;
+    int getCell(int level, int v) const;
+    // boundary vertices of a cell, in [boundaryBegin(l, c), boundaryBegin(l, c + 1)) of getBoundary(l)
+    int boundaryBegin(int level, int cell) const;
+    const std::vector<int>& getBoundary(int level) const;
+    int getBoundaryPosition(int level, int v) const; // within its cell, -1 if not a boundary vertex
+    size_t matrixBegin(int level, int cell) const;   // offset of the cell's clique matrix
+    size_t getMatrixSize(int level) const;
+
+protected:
+    const CompactGraph<T>& graph;
+    int levels, bits;
+    std::vector<int> region;
+    // indexed by level - 1
+    std::vector<std::vector<int>> cellBoundaryBegin, boundary, boundaryPosition;
+    std::vector<std::vector<size_t>> cellMatrixBegin;
+};
+
+/******************** OverlayMetric ********************/
+
+/*
+ * Clique distances of one weight column over an OverlayGraph, and queries on them.
+ *
+ * Customization fills, for every cell of every level, the flat row-major matrix of shortest
+ * distances between its boundary vertices inside the cell. Level 1 searches the original edges
+ * of the cell. Level l searches the level l - 1 overlay restricted to the cell, i.e. the cliques
+ * of its subcells plus the original edges between them. Every matrix row of a level is one search
+ * from one boundary vertex, independent of the others, so rows are computed in parallel with one
+ * workspace per thread, level by level. A traffic update only
+ * needs customize() again; the partition is kept.
+ *
+ * A query is a multi-level Dijkstra. At vertex u it uses the highest level whose cell of u
+ * contains neither endpoint. There it relaxes u's clique row and the original edges leaving that
+ * cell, or every original edge when no such level exists. The clique hops on the resulting path
+ * are unpacked level by level with searches restricted to their cell.
+ */
+template <class T>
+class OverlayMetric {
+public:
+    OverlayMetric(const OverlayGraph<T>& overlay, const std::vector<double>& weights);
+
+    void customize();
+    // distance (INF if unreachable), edges of a shortest path in path
+    double query(int source, int target, std::vector<int>& path);
+    int getSettled() const; // vertices settled by the last query
+
+protected:
+    const OverlayGraph<T>& overlay;
+    const CompactGraph<T>& graph;
+    const std::vector<double>& weights;
+    std::vector<std::vector<double>> matrices; // per level - 1, flat
+
+    struct Workspace {
+        SearchWorkspace ws;     // parent is the original edge, -1 after a clique hop
+        std::vector<int> from;  // predecessor vertex
+        std::vector<int> level; // level of the clique hop into the vertex, 0 for an original edge
+    };
+    Workspace query_;
+    std::vector<Workspace> unpack_;
+    int settled = 0;
+
+    // relaxes the arcs of the level - 1 overlay from x that stay in the given level cell
+    template <class F>
+    void cellArcs(int level, int cell, int x, F relax) const;
+    void cellSearch(int level, int cell, int source, int target, Workspace& w) const;
+    void unpack(int level, int a, int b, std::vector<int>& path);
+};
+
+/************************* OverlayGraph  **************************/
+
+template <class T>
+OverlayGraph<T>::OverlayGraph(const CompactGraph<T>& graph, int levels, int bitsPerLevel)
+    : graph(graph), levels(levels), bits(bitsPerLevel), region(partitionGraph(graph, 1 << (levels * bitsPerLevel))),
+      cellBoundaryBegin(levels), boundary(levels), boundaryPosition(levels), cellMatrixBegin(levels) {
+    int n = graph.getNumVertex();
+    for (int l = 1; l <= levels; l++) {
+        int cells = getCellCount(l);
+        std::vector<char> isBoundary(n, false);
+        for (int e = 0; e < graph.getNumEdges(); e++) {
+            int u = graph.getTail(e), v = graph.getHead(e);
+            if (getCell(l, u) != getCell(l, v)) isBoundary[u] = isBoundary[v] = true;
+        }
+
+        std::vector<int>& begin = cellBoundaryBegin[l - 1];
+        begin.assign(cells + 1, 0);
+        for (int v = 0; v < n; v++) {
+            if (isBoundary[v]) begin[getCell(l, v) + 1]++;
+        }
+        for (int c = 0; c < cells; c++) begin[c + 1] += begin[c];
+        boundary[l - 1].resize(begin[cells]);
+        boundaryPosition[l - 1].assign(n, -1);
+        std::vector<int> fill(begin.begin(), begin.end() - 1);
+        for (int v = 0; v < n; v++) {
+            if (!isBoundary[v]) continue;
+            int c = getCell(l, v);
+            boundaryPosition[l - 1][v] = fill[c] - begin[c];
+            boundary[l - 1][fill[c]++] = v;
+        }
+
+        cellMatrixBegin[l - 1].assign(cells + 1, 0);
+        for (int c = 0; c < cells; c++) {
+            size_t size = begin[c + 1] - begin[c];
+            cellMatrixBegin[l - 1][c + 1] = cellMatrixBegin[l - 1][c] + size * size;
+        }
+    }
+}
+
+template <class T>
+const CompactGraph<T>& OverlayGraph<T>::getGraph() const {
+    return graph;
+}
+
+template <class T>
+int OverlayGraph<T>::getLevels() const {
+    return levels;
+}
+
+template <class T>
+int OverlayGraph<T>::getCellCount(int level) const {
+    return 1 << (bits * (levels - level + 1));
+}
+
+template <class T>
+int OverlayGraph<T>::getCell(int level, int v) const {
+    return region[v] >> (bits * (level - 1));
+}
+
+template <class T>
+int OverlayGraph<T>::boundaryBegin(int level, int cell) const {
+    return cellBoundaryBegin[level - 1][cell];
+}
+
+template <class T>
+const std::vector<int>& OverlayGraph<T>::getBoundary(int level) const {
+    return boundary[level - 1];
+}
+
+template <class T>
+int OverlayGraph<T>::getBoundaryPosition(int level, int v) const {
+    return boundaryPosition[level - 1][v];
+}
+
+template <class T>
+size_t OverlayGraph<T>::matrixBegin(int level, int cell) const {
+    return cellMatrixBegin[level - 1][cell];
+}
+
+template <class T>
+size_t OverlayGraph<T>::getMatrixSize(int level) const {
+    return cellMatrixBegin[level - 1].back();
+}
+
+/************************* OverlayMetric  **************************/
+
+template <class T>
+OverlayMetric<T>::OverlayMetric(const OverlayGraph<T>& overlay, const std::vector<double>& weights)
+    : overlay(overlay), graph(overlay.getGraph()), weights(weights), matrices(overlay.getLevels()) {
+    customize();
+}
+
+template <class T>
+int OverlayMetric<T>::getSettled() const {
+    return settled;
+}
+
+template <class T>
+template <class F>
+void OverlayMetric<T>::cellArcs(int level, int cell, int x, F relax) const {
+    int sub = level - 1;
+    if (sub > 0) {
+        // clique of x's subcell, x being one of its boundary vertices
+        int subcell = overlay.getCell(sub, x);
+        int begin = overlay.boundaryBegin(sub, subcell), size = overlay.boundaryBegin(sub, subcell + 1) - begin;
+        const double* row = &matrices[sub - 1][overlay.matrixBegin(sub, subcell) + static_cast<size_t>(overlay.getBoundaryPosition(sub, x)) * size];
+        for (int j = 0; j < size; j++) {
+            if (row[j] != INF && j != overlay.getBoundaryPosition(sub, x)) relax(overlay.getBoundary(sub)[begin + j], row[j], -1, sub);
+        }
+    }
+    for (int e = graph.edgesBegin(x); e < graph.edgesEnd(x); e++) {
+        int y = graph.getHead(e);
+        if (weights[e] == INF || overlay.getCell(level, y) != cell) continue;
+        if (sub > 0 && overlay.getCell(sub, y) == overlay.getCell(sub, x)) continue; // inside the clique
+        relax(y, weights[e], e, 0);
+    }
+}
+
+template <class T>
+void OverlayMetric<T>::cellSearch(int level, int cell, int source, int target, Workspace& w) const {
+    SearchWorkspace& ws = w.ws;
+    ws.resize(graph.getNumVertex());
+    ws.reset();
+    w.from.resize(graph.getNumVertex());
+    w.level.resize(graph.getNumVertex());
+
+    SearchQueue pq;
+    ws.reach(source, 0, -1);
+    pq.push({0, source});
+    while (!pq.empty()) {
+        auto [d, x] = pq.top();
+        pq.pop();
+        if (ws.settled[x] || d > ws.dist[x]) continue;
+        ws.settled[x] = true;
+        ws.order.push_back(x);
+        if (x == target) return;
+        cellArcs(level, cell, x, [&](int y, double weight, int edge, int hop) {
+            if (d + weight < ws.dist[y]) {
+                ws.reach(y, d + weight, edge);
+                w.from[y] = x;
+                w.level[y] = hop;
+                pq.push({d + weight, y});
+            }
+        });
+    }
+}
+
+template <class T>
+void OverlayMetric<T>::customize() {
+    unsigned int threads = getThreadCount();
+    std::vector<Workspace> w(threads);
+    for (int l = 1; l <= overlay.getLevels(); l++) {
+        std::vector<double>& matrix = matrices[l - 1];
+        matrix.assign(overlay.getMatrixSize(l), INF);
+        const std::vector<int>& boundary = overlay.getBoundary(l);
+        // one task per matrix row, so that a few large cells still spread over every thread
+        parallelFor(boundary.size(), [&](int i, unsigned int t) {
+            int c = overlay.getCell(l, boundary[i]);
+            int begin = overlay.boundaryBegin(l, c), size = overlay.boundaryBegin(l, c + 1) - begin;
+            double* row = &matrix[overlay.matrixBegin(l, c) + static_cast<size_t>(i - begin) * size];
+            cellSearch(l, c, boundary[i], -1, w[t]);
+            for (int j = 0; j < size; j++) row[j] = w[t].ws.dist[boundary[begin + j]];
+        }, threads);
+    }
+}
+
+template <class T>
+void OverlayMetric<T>::unpack(int level, int a, int b, std::vector<int>& path) {
+    if (static_cast<int>(unpack_.size()) < level) unpack_.resize(level);
+    Workspace& w = unpack_[level - 1];
+    cellSearch(level, overlay.getCell(level, a), a, b, w);
+
+    std::vector<std::pair<int, int>> hops; // (from, to) with the edge or -level of the hop, from b back to a
+    std::vector<int> kinds;
+    for (int x = b; x != a; x = w.from[x]) {
+        hops.push_back({w.from[x], x});
+        kinds.push_back(w.ws.parent[x] != -1 ? w.ws.parent[x] : -w.level[x]);
+    }
+    for (int i = hops.size() - 1; i >= 0; i--) {
+        if (kinds[i] >= 0) path.push_back(kinds[i]);
+        else unpack(-kinds[i], hops[i].first, hops[i].second, path);
+    }
+}
+
+template <class T>
+double OverlayMetric<T>::query(int source, int target, std::vector<int>& path) {
+    int levels = overlay.getLevels();
+    auto queryLevel = [&](int u) {
+        for (int l = levels; l >= 1; l--) {
+            int c = overlay.getCell(l, u);
+            if (c != overlay.getCell(l, source) && c != overlay.getCell(l, target)) return l;
+        }
+        return 0;
+    };
+
+    Workspace& w = query_;
+    SearchWorkspace& ws = w.ws;
+    ws.resize(graph.getNumVertex());
+    ws.reset();
+    w.from.resize(graph.getNumVertex());
+    w.level.resize(graph.getNumVertex());
+    path.clear();
+
+    SearchQueue pq;
+    ws.reach(source, 0, -1);
+    pq.push({0, source});
+    while (!pq.empty()) {
+        auto [d, u] = pq.top();
+        pq.pop();
+        if (ws.settled[u] || d > ws.dist[u]) continue;
+        ws.settled[u] = true;
+        ws.order.push_back(u);
+        if (u == target) break;
+
+        auto relax = [&](int v, double weight, int edge, int hop) {
+            if (d + weight < ws.dist[v]) {
+                ws.reach(v, d + weight, edge);
+                w.from[v] = u;
+                w.level[v] = hop;
+                pq.push({d + weight, v});
+            }
+        };
+        int l = queryLevel(u);
+        if (l == 0) {
+            for (int e = graph.edgesBegin(u); e < graph.edgesEnd(u); e++) {
+                if (weights[e] != INF) relax(graph.getHead(e), weights[e], e, 0);
+            }
+            continue;
+        }
+        int cell = overlay.getCell(l, u);
+        int begin = overlay.boundaryBegin(l, cell), size = overlay.boundaryBegin(l, cell + 1) - begin;
+        int position = overlay.getBoundaryPosition(l, u);
+        const double* row = &matrices[l - 1][overlay.matrixBegin(l, cell) + static_cast<size_t>(position) * size];
+        for (int j = 0; j < size; j++) {
+            if (row[j] != INF && j != position) relax(overlay.getBoundary(l)[begin + j], row[j], -1, l);
+        }
+        for (int e = graph.edgesBegin(u); e < graph.edgesEnd(u); e++) {
+            if (weights[e] != INF && overlay.getCell(l, graph.getHead(e)) != cell) relax(graph.getHead(e), weights[e], e, 0);
+        }
+    }
+    settled = ws.order.size();
+    if (!ws.settled[target]) return INF;
+
+    std::vector<std::pair<int, int>> hops; // (from, to) with the edge or -level of the hop
+    std::vector<int> kinds;
+    for (int x = target; x != source; x = w.from[x]) {
+        hops.push_back({w.from[x], x});
+        kinds.push_back(ws.parent[x] != -1 ? ws.parent[x] : -w.level[x]);
+    }
+    for (int i = hops.size() - 1; i >= 0; i--) {
+        if (kinds[i] >= 0) path.push_back(kinds[i]);
+        else unpack(-kinds[i], hops[i].first, hops[i].second, path);
+    }
+    return ws.dist[target];
+}
+
+#endif
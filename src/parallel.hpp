@@ -0,0 +1,137 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Number of worker threads used by the parallel kernels.
+ * Falls back to 1 when the hardware concurrency cannot be determined.
+ */
+inline unsigned int getThreadCount() {
+    unsigned int n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+}
+
+/*
+ * Runs fn(i, thread) for every i in [0, count), distributing the indices dynamically
+ * over at most 'threads' workers. 'thread' is in [0, threads) and can be used to pick
+ * a per-thread workspace or accumulator. Runs inline when a single worker is enough.
+ */
+template <class F>
+void parallelFor(int count, F fn, unsigned int threads = getThreadCount()) {
+    if (count <= 0) return;
+    threads = std::min<unsigned int>(threads, count);
+    if (threads <= 1) {
+        for (int i = 0; i < count; i++) fn(i, 0u);
+        return;
+    }
+
+    std::atomic<int> next(0);
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (unsigned int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            for (int i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+                fn(i, t);
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+}
+
+/******************** WorkerPool ********************/
+
+/*
+ * Fixed set of threads kept alive between tasks, for kernels that run many short parallel
+ * steps where spawning threads each time would cost more than the step itself.
+ * run(workers, fn) calls fn(t) once for every t in [0, workers) and returns when all of them
+ * are done, which makes each call a barrier. The calling thread takes t = 0 and the pool
+ * threads the others, so a pool of 'threads' holds threads - 1 of them.
+ */
+class WorkerPool {
+public:
+    explicit WorkerPool(unsigned int threads = getThreadCount());
+    ~WorkerPool();
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    unsigned int getSize() const;
+    void run(unsigned int workers, const std::function<void(unsigned int)>& fn);
+
+protected:
+    std::vector<std::thread> pool;
+    std::mutex mutex;
+    std::condition_variable start, done;
+    const std::function<void(unsigned int)>* task = nullptr;
+    unsigned int active = 0;  // workers taking part in the current task
+    unsigned int pending = 0; // pool threads still running it
+    uint64_t generation = 0;  // bumped by every run(), wakes the pool threads
+    bool stopping = false;
+
+    void work(unsigned int t);
+};
+
+/************************* WorkerPool  **************************/
+
+inline WorkerPool::WorkerPool(unsigned int threads) {
+    threads = std::max(1u, threads);
+    pool.reserve(threads - 1);
+    for (unsigned int t = 1; t < threads; t++) pool.emplace_back(&WorkerPool::work, this, t);
+}
+
+inline WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    start.notify_all();
+    for (auto& thread : pool) thread.join();
+}
+
+inline unsigned int WorkerPool::getSize() const {
+    return pool.size() + 1;
+}
+
+inline void WorkerPool::run(unsigned int workers, const std::function<void(unsigned int)>& fn) {
+    workers = std::min(workers, getSize());
+    if (workers <= 1) {
+        fn(0);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &fn;
+        active = workers;
+        pending = workers - 1;
+        generation++;
+    }
+    start.notify_all();
+    fn(0);
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&]() { return pending == 0; });
+}
+
+inline void WorkerPool::work(unsigned int t) {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        start.wait(lock, [&]() { return stopping || generation != seen; });
+        if (stopping) return;
+        seen = generation;
+        if (t >= active) continue;
+        const std::function<void(unsigned int)>* fn = task;
+        lock.unlock();
+        (*fn)(t);
+        lock.lock();
+        if (--pending == 0) done.notify_one();
+    }
+}
+
+#endif
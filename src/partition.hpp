@@ -0,0 +1,83 @@
+#ifndef PARTITION_HPP
+#define PARTITION_HPP
+
+#include <queue>
+#include <vector>
+#include "compactgraph.hpp"
+
+/*
+ * Vertices of the given set in breadth-first order over the undirected road graph, starting
+ * from the farthest vertex found by a first sweep (a pseudo-peripheral vertex), so that cutting
+ * the order anywhere gives two compact halves. state is 0 outside the set and nonzero inside,
+ * and is left at 2 for the set; components the set splits into are visited one after the other.
+ */
+template <class T>
+std::vector<int> breadthFirstOrder(const CompactGraph<T>& graph, const std::vector<int>& vertices,
+                                   std::vector<char>& state) {
+    std::vector<int> order;
+    auto sweep = [&](int root) {
+        order.clear();
+        for (int v : vertices) state[v] = 1;
+        for (int start = root, next = 0; start != -1;) {
+            std::queue<int> queue;
+            state[start] = 2;
+            queue.push(start);
+            while (!queue.empty()) {
+                int u = queue.front();
+                queue.pop();
+                order.push_back(u);
+                auto visit = [&](int v) {
+                    if (state[v] == 1) {
+                        state[v] = 2;
+                        queue.push(v);
+                    }
+                };
+                for (int e = graph.edgesBegin(u); e < graph.edgesEnd(u); e++) visit(graph.getHead(e));
+                for (int i = graph.inEdgesBegin(u); i < graph.inEdgesEnd(u); i++) visit(graph.getTail(graph.getInEdge(i)));
+            }
+            while (next < static_cast<int>(vertices.size()) && state[vertices[next]] == 2) next++;
+            start = next < static_cast<int>(vertices.size()) ? vertices[next] : -1;
+        }
+    };
+    sweep(vertices[0]);
+    sweep(order.back());
+    return order;
+}
+
+/*
+ * Splits the vertices into regions first .. first + count - 1 by recursive BFS bisection, each
+ * side getting a share of the vertices proportional to its number of regions.
+ */
+template <class T>
+void bisectRegions(const CompactGraph<T>& graph, const std::vector<int>& vertices, int first, int count,
+                   std::vector<int>& region, std::vector<char>& inside) {
+    if (count == 1 || vertices.size() <= 1) {
+        for (int v : vertices) region[v] = first;
+        return;
+    }
+    std::vector<int> order = breadthFirstOrder(graph, vertices, inside);
+    for (int v : vertices) inside[v] = 0;
+
+    int leftCount = count / 2;
+    size_t split = vertices.size() * leftCount / count;
+    std::vector<int> left(order.begin(), order.begin() + split), right(order.begin() + split, order.end());
+    bisectRegions(graph, left, first, leftCount, region, inside);
+    bisectRegions(graph, right, first + leftCount, count - leftCount, region, inside);
+}
+
+/*
+ * Built-in partitioner: region of every vertex, in [0, regions), balanced by vertex count.
+ * Regions are numbered in bisection order, so with a power-of-two count the regions
+ * r >> k (for k = 1, 2, ...) form coarser nested partitions of the same graph.
+ */
+template <class T>
+std::vector<int> partitionGraph(const CompactGraph<T>& graph, int regions) {
+    int n = graph.getNumVertex();
+    std::vector<int> region(n, 0), vertices(n);
+    std::vector<char> inside(n, false);
+    for (int v = 0; v < n; v++) vertices[v] = v;
+    if (n > 0) bisectRegions(graph, vertices, 0, regions, region, inside);
+    return region;
+}
+
+#endif
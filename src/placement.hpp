@@ -0,0 +1,202 @@
+#ifndef PLACEMENT_HPP
+#define PLACEMENT_HPP
+
+#include <algorithm>
+#include <queue>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "compactgraph.hpp"
+#include "parallel.hpp"
+#include "search.hpp"
+
+// a demand origin/destination pair (snapshot indices) and how many trips it stands for
+struct Demand {
+    int origin;
+    int destination;
+    double weight = 1;
+};
+
+struct PlacementStep {
+    int vertex;  // snapshot index of the new parking
+    double gain; // reduction of the total weighted travel time
+};
+
+struct PlacementResult {
+    std::vector<PlacementStep> steps; // in the order they were chosen
+    double initialCost = 0;           // total weighted travel time with the existing parking only
+    double finalCost = 0;
+};
+
+/******************** ParkingPlacement ********************/
+
+/*
+ * Where to open new parking so that driving + walking trips get faster (facility location).
+ * A trip from o to d costs min over parking p of drive(o, p) + walk(p, d), with p not o or d
+ * and walk(p, d) <= maxWalkTime, as in the environmental route; a trip with no such parking
+ * costs unservedCost. The total weighted cost is a facility location objective, so its
+ * reduction is monotone submodular and greedy placement is within (1 - 1/e) of optimal.
+ *
+ * Search trees are shared: one forward driving tree per distinct origin and one bounded
+ * backward walking tree per distinct destination, built in parallel, give for each site
+ * (existing parking and candidates) the trips it could serve and at what cost, in flat arrays.
+ * Candidate gains are evaluated in parallel once; after that the lazy greedy loop only
+ * re-evaluates the candidates that reach the top of the queue with an outdated gain.
+ */
+template <class T>
+class ParkingPlacement {
+public:
+    ParkingPlacement(const CompactGraph<T>& graph, const std::vector<Demand>& demand, const std::vector<int>& existing,
+                     const std::vector<int>& candidates, double maxWalkTime, double unservedCost);
+
+    // chooses up to count new parking vertices, stopping early when none helps any more
+    PlacementResult place(int count);
+
+protected:
+    const CompactGraph<T>& graph;
+    std::vector<Demand> demand;
+    std::vector<int> sites; // existing parking first, then the candidates
+    int existingCount;
+    double unservedCost;
+
+    // trips site s could serve: (demand index, cost) for i in [siteTripsBegin[s], siteTripsBegin[s + 1])
+    std::vector<int> siteTripsBegin;
+    std::vector<std::pair<int, double>> siteTrips;
+
+    double gain(int site, const std::vector<double>& current) const;
+};
+
+/************************* ParkingPlacement  **************************/
+
+template <class T>
+ParkingPlacement<T>::ParkingPlacement(const CompactGraph<T>& graph, const std::vector<Demand>& demand,
+                                      const std::vector<int>& existing, const std::vector<int>& candidates,
+                                      double maxWalkTime, double unservedCost)
+    : graph(graph), demand(demand), existingCount(existing.size()), unservedCost(unservedCost) {
+    sites = existing;
+    sites.insert(sites.end(), candidates.begin(), candidates.end());
+    int siteCount = sites.size();
+
+    std::vector<int> origins, destinations;
+    std::unordered_map<int, int> originIndex, destinationIndex;
+    std::vector<std::vector<int>> tripsFrom; // demand indices per origin
+    for (size_t i = 0; i < demand.size(); i++) {
+        if (originIndex.insert({demand[i].origin, static_cast<int>(origins.size())}).second) {
+            origins.push_back(demand[i].origin);
+            tripsFrom.push_back({});
+        }
+        tripsFrom[originIndex[demand[i].origin]].push_back(i);
+        if (destinationIndex.insert({demand[i].destination, static_cast<int>(destinations.size())}).second) {
+            destinations.push_back(demand[i].destination);
+        }
+    }
+
+    unsigned int threads = getThreadCount();
+    std::vector<SearchWorkspace> ws(threads);
+
+    // sites within walking distance of every destination, from bounded backward trees
+    std::vector<int> siteOf(graph.getNumVertex(), -1);
+    std::vector<std::vector<int>> sitesAt; // sites sharing a vertex (existing parking listed as candidate)
+    for (int s = 0; s < siteCount; s++) {
+        if (siteOf[sites[s]] == -1) {
+            siteOf[sites[s]] = sitesAt.size();
+            sitesAt.push_back({});
+        }
+        sitesAt[siteOf[sites[s]]].push_back(s);
+    }
+    std::vector<std::vector<std::pair<int, double>>> walk(destinations.size());
+    parallelFor(destinations.size(), [&](int d, unsigned int t) {
+        shortestPathTree(graph, graph.getWeights(WALKING), destinations[d], ws[t], maxWalkTime, true);
+        for (int v : ws[t].order) {
+            if (siteOf[v] == -1) continue;
+            for (int s : sitesAt[siteOf[v]]) walk[d].push_back({s, ws[t].dist[v]});
+        }
+    }, threads);
+
+    // one driving tree per origin, read only at the sites its trips can walk from; parking
+    // further than unservedCost away could never beat leaving the trip unserved
+    std::vector<std::vector<std::tuple<int, int, double>>> served(origins.size()); // (site, trip, cost)
+    parallelFor(origins.size(), [&](int o, unsigned int t) {
+        shortestPathTree(graph, graph.getWeights(DRIVING), origins[o], ws[t], unservedCost);
+        for (int trip : tripsFrom[o]) {
+            for (const auto& [s, w] : walk[destinationIndex.at(demand[trip].destination)]) {
+                if (sites[s] == demand[trip].origin || sites[s] == demand[trip].destination) continue;
+                double d = ws[t].dist[sites[s]];
+                if (d + w < unservedCost) served[o].push_back({s, trip, d + w});
+            }
+        }
+    }, threads);
+
+    // regroup by site, counting sort on the site
+    siteTripsBegin.assign(siteCount + 1, 0);
+    for (const auto& list : served) {
+        for (const auto& entry : list) siteTripsBegin[std::get<0>(entry) + 1]++;
+    }
+    for (int s = 0; s < siteCount; s++) siteTripsBegin[s + 1] += siteTripsBegin[s];
+    siteTrips.resize(siteTripsBegin[siteCount]);
+    std::vector<int> fill(siteTripsBegin.begin(), siteTripsBegin.end() - 1);
+    for (const auto& list : served) {
+        for (const auto& [s, trip, cost] : list) siteTrips[fill[s]++] = {trip, cost};
+    }
+}
+
+template <class T>
+double ParkingPlacement<T>::gain(int site, const std::vector<double>& current) const {
+    double total = 0;
+    for (int i = siteTripsBegin[site]; i < siteTripsBegin[site + 1]; i++) {
+        const auto& [trip, cost] = siteTrips[i];
+        if (cost < current[trip]) total += demand[trip].weight * (current[trip] - cost);
+    }
+    return total;
+}
+
+template <class T>
+PlacementResult ParkingPlacement<T>::place(int count) {
+    PlacementResult result;
+    std::vector<double> current(demand.size(), unservedCost);
+    auto open = [&](int site) {
+        for (int i = siteTripsBegin[site]; i < siteTripsBegin[site + 1]; i++) {
+            const auto& [trip, cost] = siteTrips[i];
+            current[trip] = std::min(current[trip], cost);
+        }
+    };
+    for (int s = 0; s < existingCount; s++) open(s);
+    for (size_t i = 0; i < demand.size(); i++) result.initialCost += demand[i].weight * current[i];
+
+    int siteCount = sites.size();
+    std::vector<double> gains(siteCount, 0);
+    parallelFor(siteCount - existingCount, [&](int c, unsigned int) {
+        gains[existingCount + c] = gain(existingCount + c, current);
+    });
+
+    // lazy greedy: gains only shrink as parking opens, so an outdated gain is an upper bound
+    std::priority_queue<std::pair<double, int>> pq;
+    std::vector<int> evaluatedAt(siteCount, 0); // number of parking opened when the gain was computed
+    std::vector<char> chosen(siteCount, false);
+    for (int s = existingCount; s < siteCount; s++) {
+        if (gains[s] > 0) pq.push({gains[s], s});
+    }
+
+    int opened = 0;
+    while (opened < count && !pq.empty()) {
+        auto [g, s] = pq.top();
+        pq.pop();
+        if (chosen[s]) continue;
+        if (evaluatedAt[s] != opened) {
+            evaluatedAt[s] = opened;
+            double fresh = gain(s, current);
+            if (fresh > 0) pq.push({fresh, s});
+            continue;
+        }
+        chosen[s] = true;
+        open(s);
+        result.steps.push_back({sites[s], g});
+        opened++;
+    }
+
+    for (size_t i = 0; i < demand.size(); i++) result.finalCost += demand[i].weight * current[i];
+    return result;
+}
+
+#endif
@@ -0,0 +1,180 @@
+#ifndef POI_HPP
+#define POI_HPP
+
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "compactgraph.hpp"
+#include "search.hpp"
+
+// category every parking vertex belongs to
+const std::string PARKING_CATEGORY = "parking";
+
+/******************** PoiIndex ********************/
+
+/*
+ * Tagged points of interest of a snapshot: one vertex list per category, built once
+ * from the vertex tags (and the parking flags), so no query has to scan the whole graph.
+ *
+ * nearest() answers "k closest POIs of a category by drive/walk time" with a Dijkstra that
+ * stops as soon as k of them are settled. For the categories and profiles that are queried
+ * often, precompute() stores for every vertex its K closest POIs (a multi-source, k-label
+ * search run backwards from all POIs at once); nearest() then answers any k <= K with a
+ * table lookup.
+ */
+template <class T>
+class PoiIndex {
+public:
+    explicit PoiIndex(const CompactGraph<T>& graph);
+
+    std::vector<std::string> getCategories() const;
+    // vertex indices of a category, empty if unknown
+    const std::vector<int>& getVertices(const std::string& category) const;
+
+    void precompute(const std::string& category, int profile, int k);
+    bool hasCandidates(const std::string& category, int profile) const;
+
+    // (vertex index, distance) of the k closest POIs of the category, closest first
+    std::vector<std::pair<int, double>> nearest(int source, const std::string& category, int k,
+                                                int profile, SearchWorkspace& ws) const;
+
+protected:
+    struct CandidateLists {
+        int k = 0;
+        std::vector<std::pair<int, double>> entries; // k per vertex, (-1, INF) when fewer POIs are reachable
+    };
+
+    const CompactGraph<T>& graph;
+    std::map<std::string, std::vector<int>> categories;
+    std::map<std::string, std::vector<char>> membership;
+    std::map<std::pair<std::string, int>, CandidateLists> candidates;
+};
+
+/************************* PoiIndex  **************************/
+
+template <class T>
+PoiIndex<T>::PoiIndex(const CompactGraph<T>& graph) : graph(graph) {
+    int n = graph.getNumVertex();
+    categories[PARKING_CATEGORY];
+    for (int v = 0; v < n; v++) {
+        if (graph.hasParking(v)) categories[PARKING_CATEGORY].push_back(v);
+        for (const std::string& tag : graph.getVertex(v)->getTags()) {
+            std::vector<int>& list = categories[tag];
+            if (list.empty() || list.back() != v) list.push_back(v);
+        }
+    }
+    for (const auto& [category, vertices] : categories) {
+        std::vector<char>& member = membership[category];
+        member.assign(n, false);
+        for (int v : vertices) member[v] = true;
+    }
+}
+
+template <class T>
+std::vector<std::string> PoiIndex<T>::getCategories() const {
+    std::vector<std::string> result;
+    for (const auto& pair : categories) result.push_back(pair.first);
+    return result;
+}
+
+template <class T>
+const std::vector<int>& PoiIndex<T>::getVertices(const std::string& category) const {
+    static const std::vector<int> empty;
+    auto it = categories.find(category);
+    return (it != categories.end()) ? it->second : empty;
+}
+
+template <class T>
+bool PoiIndex<T>::hasCandidates(const std::string& category, int profile) const {
+    return candidates.count({category, profile}) > 0;
+}
+
+/*
+ * k-label search from all POIs of the category along incoming edges: every vertex keeps
+ * the first k distinct POIs that reach it, which are its k closest ones.
+ */
+template <class T>
+void PoiIndex<T>::precompute(const std::string& category, int profile, int k) {
+    int n = graph.getNumVertex();
+    const std::vector<double>& weights = graph.getWeights(profile);
+    CandidateLists lists;
+    lists.k = k;
+    lists.entries.assign(static_cast<size_t>(n) * k, {-1, INF});
+    std::vector<int> count(n, 0);
+
+    typedef std::tuple<double, int, int> Label; // distance, vertex, poi
+    std::priority_queue<Label, std::vector<Label>, std::greater<Label>> pq;
+    for (int poi : getVertices(category)) pq.push({0, poi, poi});
+
+    while (!pq.empty()) {
+        auto [d, v, poi] = pq.top();
+        pq.pop();
+        if (count[v] >= k) continue;
+        auto first = lists.entries.begin() + static_cast<size_t>(v) * k;
+        bool known = false;
+        for (int i = 0; i < count[v]; i++) known |= (first + i)->first == poi;
+        if (known) continue;
+        *(first + count[v]++) = {poi, d};
+
+        for (int i = graph.inEdgesBegin(v); i < graph.inEdgesEnd(v); i++) {
+            int e = graph.getInEdge(i);
+            if (weights[e] == INF) continue;
+            int u = graph.getTail(e);
+            if (count[u] < k) pq.push({d + weights[e], u, poi});
+        }
+    }
+    candidates[{category, profile}] = std::move(lists);
+}
+
+template <class T>
+std::vector<std::pair<int, double>> PoiIndex<T>::nearest(int source, const std::string& category, int k,
+                                                         int profile, SearchWorkspace& ws) const {
+    if (source < 0 || source >= graph.getNumVertex()) {
+        throw std::runtime_error("POI error: invalid source index " + std::to_string(source) + "\n");
+    }
+    std::vector<std::pair<int, double>> result;
+    auto member = membership.find(category);
+    if (member == membership.end() || k <= 0) return result;
+
+    auto lists = candidates.find({category, profile});
+    if (lists != candidates.end() && k <= lists->second.k) {
+        auto first = lists->second.entries.begin() + static_cast<size_t>(source) * lists->second.k;
+        for (int i = 0; i < k && (first + i)->first != -1; i++) result.push_back(*(first + i));
+        return result;
+    }
+
+    const std::vector<double>& weights = graph.getWeights(profile);
+    ws.resize(graph.getNumVertex());
+    ws.reset();
+    SearchQueue pq;
+    ws.reach(source, 0, -1);
+    pq.push({0, source});
+
+    while (!pq.empty()) {
+        auto [d, u] = pq.top();
+        pq.pop();
+        if (ws.settled[u] || d > ws.dist[u]) continue;
+        ws.settled[u] = true;
+        ws.order.push_back(u);
+        if (member->second[u]) {
+            result.push_back({u, d});
+            if (static_cast<int>(result.size()) == k) break;
+        }
+
+        for (int e = graph.edgesBegin(u); e < graph.edgesEnd(u); e++) {
+            double w = weights[e];
+            if (w == INF) continue;
+            int v = graph.getHead(e);
+            if (d + w < ws.dist[v]) {
+                ws.reach(v, d + w, e);
+                pq.push({d + w, v});
+            }
+        }
+    }
+    return result;
+}
+
+#endif
@@ -0,0 +1,166 @@
+#ifndef REACH_HPP
+#define REACH_HPP
+
+#include <algorithm>
+#include <vector>
+#include "compactgraph.hpp"
+#include "parallel.hpp"
+#include "search.hpp"
+
+/******************** ReachBounds ********************/
+
+/*
+ * Upper bounds on the reach of every vertex for one weight column, for pruning A* searches.
+ * The reach of v is the largest min(d(s, v), d(v, t)) over the shortest s-t paths through v.
+ * A search towards t can skip v when reach(v) < d(s, v) and reach(v) < lowerBound(v, t).
+ *
+ * Exact reaches need a full tree per vertex, so the bounds come from partial trees below a
+ * threshold R. The partial tree of s is grown to radius R + maxOut(s) + R + W, where maxOut(s)
+ * is the longest edge leaving s and W the longest edge overall. Heights are taken over the tight
+ * edges between settled vertices, processed in reverse settle order. A vertex is open, with
+ * infinite height, when a tight edge leaves the tree or reaches a vertex settled before it
+ * (possible only through zero-weight edges). s then records min(d(s, v), height(v)) for every v
+ * closer than R + maxOut(s).
+ *
+ * This is enough for a shortest path through v that starts closer than that. A path that starts
+ * farther away has a vertex s' with R <= d(s', v) < R + maxOut(s') whose partial tree sees v at
+ * least up to min(R, d(v, t)). So a vertex whose recorded maximum stays below R has that maximum
+ * as a valid reach bound. Every other vertex gets an infinite reach and is never pruned.
+ *
+ * R is the median distance, over a few sample vertices, at which a search has settled ballSize
+ * vertices. The partial trees are independent and are grown in parallel, one workspace and one
+ * reach array per thread.
+ */
+template <class T>
+class ReachBounds {
+public:
+    ReachBounds(const CompactGraph<T>& graph, const std::vector<double>& weights, int ballSize);
+
+    double getThreshold() const;
+    double getReach(int v) const; // INF when not below the threshold
+
+    // A* with heuristic(v), a consistent lower bound on the distance from v to the target, that
+    // also prunes by reach against it; same contract as shortestPath. A zero heuristic prunes nothing.
+    template <class H>
+    double shortestPath(int source, int target, SearchWorkspace& ws, H heuristic) const;
+
+protected:
+    const CompactGraph<T>& graph;
+    const std::vector<double>& weights;
+    double threshold = 0;
+    std::vector<double> reach;
+
+    void partialTree(int source, double maxEdge, SearchWorkspace& ws, std::vector<double>& height,
+                     std::vector<double>& local) const;
+};
+
+/************************* ReachBounds  **************************/
+
+template <class T>
+ReachBounds<T>::ReachBounds(const CompactGraph<T>& graph, const std::vector<double>& weights, int ballSize)
+    : graph(graph), weights(weights) {
+    int n = graph.getNumVertex();
+    reach.assign(n, INF);
+    if (n == 0) return;
+
+    double maxEdge = 0;
+    for (double w : weights) {
+        if (w != INF) maxEdge = std::max(maxEdge, w);
+    }
+
+    std::vector<double> radii;
+    SearchWorkspace ws(n);
+    int samples = std::min(n, 16);
+    for (int i = 0; i < samples; i++) {
+        shortestPathTree(graph, weights, static_cast<int>(static_cast<long long>(i) * n / samples), ws);
+        int k = std::min(ballSize, static_cast<int>(ws.order.size())) - 1;
+        radii.push_back(ws.dist[ws.order[std::max(k, 0)]]);
+    }
+    std::nth_element(radii.begin(), radii.begin() + radii.size() / 2, radii.end());
+    threshold = radii[radii.size() / 2];
+    if (threshold <= 0) return; // nothing below the threshold, no vertex can be pruned
+
+    unsigned int threads = getThreadCount();
+    std::vector<SearchWorkspace> workspaces(threads);
+    std::vector<std::vector<double>> heights(threads, std::vector<double>(n, -1));
+    std::vector<std::vector<double>> locals(threads, std::vector<double>(n, 0));
+    parallelFor(n, [&](int s, unsigned int t) {
+        partialTree(s, maxEdge, workspaces[t], heights[t], locals[t]);
+    }, threads);
+
+    for (int v = 0; v < n; v++) {
+        double r = 0;
+        for (const std::vector<double>& local : locals) r = std::max(r, local[v]);
+        reach[v] = r < threshold ? r : INF;
+    }
+}
+
+template <class T>
+double ReachBounds<T>::getThreshold() const {
+    return threshold;
+}
+
+template <class T>
+double ReachBounds<T>::getReach(int v) const {
+    return reach[v];
+}
+
+template <class T>
+void ReachBounds<T>::partialTree(int source, double maxEdge, SearchWorkspace& ws, std::vector<double>& height,
+                                 std::vector<double>& local) const {
+    double maxOut = 0;
+    for (int e = graph.edgesBegin(source); e < graph.edgesEnd(source); e++) {
+        if (weights[e] != INF) maxOut = std::max(maxOut, weights[e]);
+    }
+    double recordLimit = threshold + maxOut;
+    shortestPathTree(graph, weights, source, ws, recordLimit + threshold + maxEdge);
+
+    // height stays -1 outside the tree and for vertices not processed yet
+    for (int i = ws.order.size() - 1; i >= 0; i--) {
+        int u = ws.order[i];
+        double d = ws.dist[u], h = 0;
+        for (int e = graph.edgesBegin(u); e < graph.edgesEnd(u) && h != INF; e++) {
+            double w = weights[e];
+            int v = graph.getHead(e);
+            if (w == INF || d + w > ws.dist[v]) continue; // not tight; heads of settled vertices all have a label
+            h = ws.settled[v] && height[v] >= 0 ? std::max(h, height[v] + w) : INF;
+        }
+        height[u] = h;
+        if (d < recordLimit) local[u] = std::max(local[u], std::min(d, h));
+    }
+    for (int u : ws.order) height[u] = -1;
+}
+
+template <class T>
+template <class H>
+double ReachBounds<T>::shortestPath(int source, int target, SearchWorkspace& ws, H heuristic) const {
+    ws.resize(graph.getNumVertex());
+    ws.reset();
+
+    SearchQueue pq; // keyed on distance + heuristic
+    ws.reach(source, 0, -1);
+    pq.push({heuristic(source), source});
+    while (!pq.empty()) {
+        int u = pq.top().second;
+        pq.pop();
+        if (ws.settled[u]) continue;
+        ws.settled[u] = true;
+        ws.order.push_back(u);
+        double d = ws.dist[u];
+        if (u == target) return d;
+
+        for (int e = graph.edgesBegin(u); e < graph.edgesEnd(u); e++) {
+            double w = weights[e];
+            if (w == INF) continue;
+            int v = graph.getHead(e);
+            if (ws.settled[v] || d + w >= ws.dist[v]) continue;
+            double bound = heuristic(v);
+            if (reach[v] < d + w && reach[v] < bound) continue; // no shortest path to the target through v
+            ws.reach(v, d + w, e);
+            pq.push({d + w + bound, v});
+        }
+    }
+    return INF;
+}
+
+#endif
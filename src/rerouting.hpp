@@ -0,0 +1,144 @@
+#ifndef REROUTING_HPP
+#define REROUTING_HPP
+
+#include <vector>
+#include "compactgraph.hpp"
+#include "search.hpp"
+
+/******************** RouteSession ********************/
+
+/*
+ * Routes towards one fixed target from any number of start vertices, for re-routing a driver
+ * who left the route or hit a closure.
+ *
+ * The session keeps one backward Dijkstra from the target, resumed only as far as needed: a route
+ * from v settles vertices until v is settled, then reads the path off the tree. A later start
+ * that is already settled costs no search at all, and otherwise the search continues from where
+ * it stopped. Every answer is therefore exactly the distance a fresh search would give.
+ *
+ * Closures only ever lengthen paths, so close() keeps every settled vertex whose tree path avoids
+ * the closed edges and unsettles the subtrees hanging below a closed tree edge. Their labels, and
+ * those of the old frontier, are rebuilt from the kept vertices, and the search resumes from
+ * there. Any other weight change needs a new session.
+ */
+template <class T>
+class RouteSession {
+public:
+    RouteSession(const CompactGraph<T>& graph, const std::vector<double>& weights, int target);
+
+    // distance from source to the target (INF if unreachable), edges of the route in path
+    double route(int source, std::vector<int>& path);
+    // makes the edges impassable for the rest of the session
+    void close(const std::vector<int>& edges);
+
+    int getTarget() const;
+    int getSettled() const; // vertices settled so far, over the whole session
+
+protected:
+    const CompactGraph<T>& graph;
+    std::vector<double> weights;
+    int target;
+    SearchWorkspace ws; // parent[v] is the edge leaving v towards the target
+    SearchQueue pq;
+    int settledCount = 0;
+
+    void settleUntil(int v);
+    void relax(int u);
+};
+
+/************************* RouteSession  **************************/
+
+template <class T>
+RouteSession<T>::RouteSession(const CompactGraph<T>& graph, const std::vector<double>& weights, int target)
+    : graph(graph), weights(weights), target(target), ws(graph.getNumVertex()) {
+    ws.reach(target, 0, -1);
+    pq.push({0, target});
+}
+
+template <class T>
+int RouteSession<T>::getTarget() const {
+    return target;
+}
+
+template <class T>
+int RouteSession<T>::getSettled() const {
+    return settledCount;
+}
+
+template <class T>
+void RouteSession<T>::relax(int u) {
+    double d = ws.dist[u];
+    for (int i = graph.inEdgesBegin(u); i < graph.inEdgesEnd(u); i++) {
+        int e = graph.getInEdge(i);
+        if (weights[e] == INF) continue;
+        int v = graph.getTail(e);
+        if (!ws.settled[v] && d + weights[e] < ws.dist[v]) {
+            ws.reach(v, d + weights[e], e);
+            pq.push({d + weights[e], v});
+        }
+    }
+}
+
+template <class T>
+void RouteSession<T>::settleUntil(int v) {
+    while (!ws.settled[v] && !pq.empty()) {
+        auto [d, u] = pq.top();
+        pq.pop();
+        if (ws.settled[u] || d > ws.dist[u]) continue;
+        ws.settled[u] = true;
+        ws.order.push_back(u);
+        settledCount++;
+        relax(u);
+    }
+}
+
+template <class T>
+double RouteSession<T>::route(int source, std::vector<int>& path) {
+    settleUntil(source);
+    path.clear();
+    if (!ws.settled[source]) return INF;
+    for (int v = source; v != target; v = graph.getHead(ws.parent[v])) path.push_back(ws.parent[v]);
+    return ws.dist[source];
+}
+
+template <class T>
+void RouteSession<T>::close(const std::vector<int>& edges) {
+    // labels (settled or not) that do not come through a closed edge are still right
+    bool treeEdge = false;
+    for (int e : edges) {
+        weights[e] = INF;
+        if (ws.parent[graph.getTail(e)] == e) treeEdge = true;
+    }
+    if (!treeEdge) return;
+
+    // settled vertices whose path to the target uses a closed edge, in settle order
+    std::vector<char> affected(graph.getNumVertex(), false);
+    std::vector<int> kept;
+    for (int v : ws.order) {
+        int e = ws.parent[v];
+        if (e != -1 && (weights[e] == INF || affected[graph.getHead(e)])) affected[v] = true;
+        else kept.push_back(v);
+    }
+
+    // drop every label that is not final and rebuild them from the kept vertices
+    std::vector<int> open;
+    for (int v : ws.touched) {
+        if (ws.dist[v] == INF || (ws.settled[v] && !affected[v])) continue;
+        ws.dist[v] = INF;
+        ws.parent[v] = -1;
+        ws.settled[v] = false;
+        open.push_back(v);
+    }
+    ws.order = kept;
+    pq = SearchQueue();
+    for (int v : open) {
+        for (int e = graph.edgesBegin(v); e < graph.edgesEnd(v); e++) {
+            int w = graph.getHead(e);
+            if (weights[e] == INF || !ws.settled[w]) continue;
+            if (ws.dist[w] + weights[e] < ws.dist[v]) ws.reach(v, ws.dist[w] + weights[e], e);
+        }
+        if (ws.dist[v] != INF) pq.push({ws.dist[v], v});
+    }
+}
+
+#endif
@@ -0,0 +1,183 @@
+#ifndef SEARCH_HPP
+#define SEARCH_HPP
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+#include "compactgraph.hpp"
+
+/******************** SearchWorkspace ********************/
+
+/*
+ * State of one search over a CompactGraph: tentative distances, parent edges and
+ * the settled vertices in settle order. Only the vertices touched by the last search
+ * are cleared on reset, so a workspace can be reused for many bounded searches
+ * without paying O(n) each time. One workspace per thread.
+ */
+struct SearchWorkspace {
+    std::vector<double> dist;
+    std::vector<int> parent; // edge id used to reach the vertex, -1 for roots
+    std::vector<char> settled;
+    std::vector<int> touched;
+    std::vector<int> order; // settled vertices, in non-decreasing distance
+
+    explicit SearchWorkspace(int n = 0);
+    void resize(int n);
+    void reset();
+    void reach(int v, double d, int edge); // sets the label of v and remembers it for reset
+};
+
+typedef std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int>>,
+                            std::greater<std::pair<double, int>>> SearchQueue;
+
+/*
+ * Dijkstra from several roots at once, each with its initial distance (seeds are
+ * pairs of vertex index and distance). Stops settling once the distance exceeds cutoff.
+ * With backward set, the search follows incoming edges, computing distances *to* the roots,
+ * and parent[v] is the edge leaving v towards the roots.
+ */
+template <class T>
+void shortestPathTree(const CompactGraph<T>& graph, const std::vector<double>& weights,
+                      const std::vector<std::pair<int, double>>& seeds, SearchWorkspace& ws,
+                      double cutoff = INF, bool backward = false) {
+    ws.resize(graph.getNumVertex());
+    ws.reset();
+
+    SearchQueue pq;
+    for (const auto& seed : seeds) {
+        if (seed.second < ws.dist[seed.first]) {
+            ws.reach(seed.first, seed.second, -1);
+            pq.push({seed.second, seed.first});
+        }
+    }
+
+    while (!pq.empty()) {
+        auto [d, u] = pq.top();
+        pq.pop();
+        if (ws.settled[u] || d > ws.dist[u]) continue;
+        if (d > cutoff) break;
+        ws.settled[u] = true;
+        ws.order.push_back(u);
+
+        int begin = backward ? graph.inEdgesBegin(u) : graph.edgesBegin(u);
+        int end = backward ? graph.inEdgesEnd(u) : graph.edgesEnd(u);
+        for (int i = begin; i < end; i++) {
+            int e = backward ? graph.getInEdge(i) : i;
+            double w = weights[e];
+            if (w == INF) continue;
+            int v = backward ? graph.getTail(e) : graph.getHead(e);
+            double newDist = d + w;
+            if (newDist < ws.dist[v]) {
+                ws.reach(v, newDist, e);
+                pq.push({newDist, v});
+            }
+        }
+    }
+}
+
+/*
+ * Single-root convenience overload of the above.
+ */
+template <class T>
+void shortestPathTree(const CompactGraph<T>& graph, const std::vector<double>& weights, int source,
+                      SearchWorkspace& ws, double cutoff = INF, bool backward = false) {
+    shortestPathTree(graph, weights, std::vector<std::pair<int, double>>{{source, 0}}, ws, cutoff, backward);
+}
+
+/*
+ * Point-to-point A* that stops as soon as the target is settled. heuristic(v) must be a
+ * consistent lower bound on the distance from v to the target (0 gives plain Dijkstra).
+ * Returns the distance (INF if unreachable); the path can be read with extractPath.
+ */
+template <class T, class H>
+double shortestPath(const CompactGraph<T>& graph, const std::vector<double>& weights,
+                    int source, int target, SearchWorkspace& ws, H heuristic) {
+    ws.resize(graph.getNumVertex());
+    ws.reset();
+
+    SearchQueue pq; // keyed on distance + heuristic
+    ws.reach(source, 0, -1);
+    pq.push({heuristic(source), source});
+
+    while (!pq.empty()) {
+        int u = pq.top().second;
+        pq.pop();
+        if (ws.settled[u]) continue; // with a consistent heuristic the first pop is final
+        ws.settled[u] = true;
+        ws.order.push_back(u);
+        double d = ws.dist[u];
+        if (u == target) return d;
+
+        for (int e = graph.edgesBegin(u); e < graph.edgesEnd(u); e++) {
+            double w = weights[e];
+            if (w == INF) continue;
+            int v = graph.getHead(e);
+            if (d + w < ws.dist[v]) {
+                ws.reach(v, d + w, e);
+                pq.push({d + w + heuristic(v), v});
+            }
+        }
+    }
+    return INF;
+}
+
+/*
+ * Point-to-point Dijkstra, see above.
+ */
+template <class T>
+double shortestPath(const CompactGraph<T>& graph, const std::vector<double>& weights,
+                    int source, int target, SearchWorkspace& ws) {
+    return shortestPath(graph, weights, source, target, ws, [](int) { return 0.0; });
+}
+
+/*
+ * Edge ids of the tree path from the root to v, in travel order.
+ * For backward trees the path goes from v to the root.
+ */
+template <class T>
+std::vector<int> extractPath(const CompactGraph<T>& graph, const SearchWorkspace& ws, int v, bool backward = false) {
+    std::vector<int> path;
+    if (ws.dist[v] == INF) return path;
+    for (int e = ws.parent[v]; e != -1; ) {
+        path.push_back(e);
+        int next = backward ? graph.getHead(e) : graph.getTail(e);
+        e = ws.parent[next];
+    }
+    if (!backward) std::reverse(path.begin(), path.end());
+    return path;
+}
+
+/************************* SearchWorkspace  **************************/
+
+inline SearchWorkspace::SearchWorkspace(int n) {
+    resize(n);
+}
+
+inline void SearchWorkspace::resize(int n) {
+    if (static_cast<int>(dist.size()) == n) return;
+    dist.assign(n, INF);
+    parent.assign(n, -1);
+    settled.assign(n, false);
+    touched.clear();
+    order.clear();
+}
+
+inline void SearchWorkspace::reset() {
+    for (int v : touched) {
+        dist[v] = INF;
+        parent[v] = -1;
+        settled[v] = false;
+    }
+    touched.clear();
+    order.clear();
+}
+
+inline void SearchWorkspace::reach(int v, double d, int edge) {
+    if (dist[v] == INF) touched.push_back(v);
+    dist[v] = d;
+    parent[v] = edge;
+}
+
+#endif
@@ -0,0 +1,294 @@
+#ifndef SPATIAL_HPP
+#define SPATIAL_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "compactgraph.hpp"
+#include "parallel.hpp"
+
+const double EARTH_RADIUS = 6371000.0; // meters
+
+/*
+ * Great-circle distance in meters between two latitude/longitude pairs (degrees).
+ */
+inline double haversineDistance(double lat1, double lon1, double lat2, double lon2) {
+    const double toRad = M_PI / 180.0;
+    double dLat = (lat2 - lat1) * toRad;
+    double dLon = (lon2 - lon1) * toRad;
+    double a = std::sin(dLat / 2) * std::sin(dLat / 2) +
+               std::cos(lat1 * toRad) * std::cos(lat2 * toRad) * std::sin(dLon / 2) * std::sin(dLon / 2);
+    return 2 * EARTH_RADIUS * std::asin(std::min(1.0, std::sqrt(a)));
+}
+
+/******************** PackedRTree ********************/
+
+struct Box {
+    double minX, minY, maxX, maxY;
+};
+
+/*
+ * Static R-tree packed with Sort-Tile-Recursive: items are sorted into vertical slices
+ * and then by y inside each slice, and every NODE_SIZE consecutive boxes of a level
+ * become one node of the level above. All levels live in one flat array of boxes,
+ * so the children of a node are a contiguous range and no pointers are stored.
+ */
+class PackedRTree {
+public:
+    static const int NODE_SIZE = 16;
+
+    void build(const std::vector<Box>& items);
+    int size() const;
+
+    /*
+     * Best-first search for the k items closest to (x, y), no further than maxDistance.
+     * itemDistance(item) returns the exact distance to an item, which must be at least
+     * the distance to its box. Results are (distance, item) pairs, closest first.
+     */
+    template <class D>
+    std::vector<std::pair<double, int>> nearest(double x, double y, int k, double maxDistance, D itemDistance) const;
+
+protected:
+    std::vector<Box> boxes;       // leaves (in packed order) first, then each upper level
+    std::vector<int> itemIds;     // packed leaf position -> item
+    std::vector<int> levelBegin;  // position of the first box of each level, plus the end
+
+    static double boxDistance(const Box& box, double x, double y);
+};
+
+/******************** SpatialIndex ********************/
+
+// a point projected onto an edge: 'fraction' of the way from its tail to its head
+struct EdgeSnap {
+    int edge;
+    double fraction;
+    double distance; // meters
+};
+
+/*
+ * Nearest-vertex and nearest-edge snapping of GPS positions onto a snapshot with coordinates.
+ * Positions are projected to a local equirectangular plane in meters centered on the
+ * graph, which is accurate at city scale, and indexed with two packed R-trees.
+ * Two-way segments are indexed once; the snapped edge is the one leaving the smaller index.
+ */
+template <class T>
+class SpatialIndex {
+public:
+    explicit SpatialIndex(const CompactGraph<T>& graph);
+
+    int nearestVertex(double latitude, double longitude) const;
+    EdgeSnap nearestEdge(double latitude, double longitude) const;
+    // up to k edges within maxDistance meters, closest first
+    std::vector<EdgeSnap> nearestEdges(double latitude, double longitude, int k, double maxDistance) const;
+
+    // parallel batch versions, one result per (latitude, longitude) point
+    std::vector<int> snapToVertices(const std::vector<std::pair<double, double>>& points) const;
+    std::vector<EdgeSnap> snapToEdges(const std::vector<std::pair<double, double>>& points) const;
+
+protected:
+    const CompactGraph<T>& graph;
+    double originLat, originLon, lonScale;
+    std::vector<double> xs, ys; // projected vertex positions
+    std::vector<int> indexedEdges;
+    PackedRTree vertexTree, edgeTree;
+
+    void project(double latitude, double longitude, double& x, double& y) const;
+    EdgeSnap projectOnEdge(int edge, double x, double y) const;
+};
+
+/************************* PackedRTree  **************************/
+
+inline int PackedRTree::size() const {
+    return itemIds.size();
+}
+
+inline void PackedRTree::build(const std::vector<Box>& items) {
+    int n = items.size();
+    std::vector<int> order(n);
+    for (int i = 0; i < n; i++) order[i] = i;
+    auto centerX = [&](int i) { return items[i].minX + items[i].maxX; };
+    auto centerY = [&](int i) { return items[i].minY + items[i].maxY; };
+
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return centerX(a) < centerX(b); });
+    int leaves = (n + NODE_SIZE - 1) / NODE_SIZE;
+    int slices = std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(leaves)))));
+    int sliceSize = slices * NODE_SIZE;
+    for (int first = 0; first < n; first += sliceSize) {
+        int last = std::min(n, first + sliceSize);
+        std::sort(order.begin() + first, order.begin() + last, [&](int a, int b) { return centerY(a) < centerY(b); });
+    }
+
+    boxes.clear();
+    itemIds = order;
+    levelBegin.assign(1, 0);
+    for (int i : order) boxes.push_back(items[i]);
+
+    // each level groups NODE_SIZE consecutive boxes of the level below
+    while (static_cast<int>(boxes.size()) - levelBegin.back() > 1) {
+        int begin = levelBegin.back();
+        int end = boxes.size();
+        levelBegin.push_back(end);
+        for (int first = begin; first < end; first += NODE_SIZE) {
+            Box box = boxes[first];
+            for (int i = first + 1; i < std::min(end, first + NODE_SIZE); i++) {
+                box.minX = std::min(box.minX, boxes[i].minX);
+                box.minY = std::min(box.minY, boxes[i].minY);
+                box.maxX = std::max(box.maxX, boxes[i].maxX);
+                box.maxY = std::max(box.maxY, boxes[i].maxY);
+            }
+            boxes.push_back(box);
+        }
+    }
+    levelBegin.push_back(boxes.size());
+}
+
+inline double PackedRTree::boxDistance(const Box& box, double x, double y) {
+    double dx = std::max({box.minX - x, 0.0, x - box.maxX});
+    double dy = std::max({box.minY - y, 0.0, y - box.maxY});
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+template <class D>
+std::vector<std::pair<double, int>> PackedRTree::nearest(double x, double y, int k, double maxDistance, D itemDistance) const {
+    std::vector<std::pair<double, int>> result;
+    if (itemIds.empty() || k <= 0) return result;
+
+    // (distance, level, position in boxes); level -1 marks an item with its exact distance
+    typedef std::tuple<double, int, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pq;
+    int top = levelBegin.size() - 2;
+    for (int i = levelBegin[top]; i < levelBegin[top + 1]; i++) pq.push({boxDistance(boxes[i], x, y), top, i});
+
+    while (!pq.empty() && static_cast<int>(result.size()) < k) {
+        auto [d, level, pos] = pq.top();
+        pq.pop();
+        if (d > maxDistance) break;
+
+        if (level == -1) {
+            result.push_back({d, itemIds[pos]});
+        } else if (level == 0) {
+            pq.push({itemDistance(itemIds[pos]), -1, pos});
+        } else {
+            int first = levelBegin[level - 1] + (pos - levelBegin[level]) * NODE_SIZE;
+            int last = std::min(levelBegin[level], first + NODE_SIZE);
+            for (int child = first; child < last; child++) {
+                pq.push({boxDistance(boxes[child], x, y), level - 1, child});
+            }
+        }
+    }
+    return result;
+}
+
+/************************* SpatialIndex  **************************/
+
+template <class T>
+SpatialIndex<T>::SpatialIndex(const CompactGraph<T>& graph) : graph(graph) {
+    if (!graph.hasCoordinates()) {
+        throw std::runtime_error("Spatial index error: not every location has coordinates\n");
+    }
+
+    int n = graph.getNumVertex();
+    originLat = 0;
+    originLon = 0;
+    for (int v = 0; v < n; v++) {
+        originLat += graph.getLatitude(v) / n;
+        originLon += graph.getLongitude(v) / n;
+    }
+    lonScale = std::cos(originLat * M_PI / 180.0);
+
+    std::vector<Box> vertexBoxes;
+    xs.resize(n);
+    ys.resize(n);
+    for (int v = 0; v < n; v++) {
+        project(graph.getLatitude(v), graph.getLongitude(v), xs[v], ys[v]);
+        vertexBoxes.push_back({xs[v], ys[v], xs[v], ys[v]});
+    }
+    vertexTree.build(vertexBoxes);
+
+    std::vector<Box> edgeBoxes;
+    for (int e = 0; e < graph.getNumEdges(); e++) {
+        int u = graph.getTail(e), v = graph.getHead(e);
+        if (u > v && graph.getEdge(e)->getReverse() != nullptr) continue; // indexed from the other side
+        indexedEdges.push_back(e);
+        edgeBoxes.push_back({std::min(xs[u], xs[v]), std::min(ys[u], ys[v]), std::max(xs[u], xs[v]), std::max(ys[u], ys[v])});
+    }
+    edgeTree.build(edgeBoxes);
+}
+
+template <class T>
+void SpatialIndex<T>::project(double latitude, double longitude, double& x, double& y) const {
+    const double toMeters = EARTH_RADIUS * M_PI / 180.0;
+    x = (longitude - originLon) * toMeters * lonScale;
+    y = (latitude - originLat) * toMeters;
+}
+
+template <class T>
+EdgeSnap SpatialIndex<T>::projectOnEdge(int edge, double x, double y) const {
+    int u = graph.getTail(edge), v = graph.getHead(edge);
+    double dx = xs[v] - xs[u], dy = ys[v] - ys[u];
+    double length2 = dx * dx + dy * dy;
+    double t = length2 > 0 ? ((x - xs[u]) * dx + (y - ys[u]) * dy) / length2 : 0;
+    t = std::clamp(t, 0.0, 1.0);
+    double px = xs[u] + t * dx - x, py = ys[u] + t * dy - y;
+    return {edge, t, std::sqrt(px * px + py * py)};
+}
+
+template <class T>
+int SpatialIndex<T>::nearestVertex(double latitude, double longitude) const {
+    double x, y;
+    project(latitude, longitude, x, y);
+    auto found = vertexTree.nearest(x, y, 1, INF, [&](int v) {
+        return std::sqrt((xs[v] - x) * (xs[v] - x) + (ys[v] - y) * (ys[v] - y));
+    });
+    return found.empty() ? -1 : found[0].second;
+}
+
+template <class T>
+std::vector<EdgeSnap> SpatialIndex<T>::nearestEdges(double latitude, double longitude, int k, double maxDistance) const {
+    double x, y;
+    project(latitude, longitude, x, y);
+    auto found = edgeTree.nearest(x, y, k, maxDistance, [&](int item) {
+        return projectOnEdge(indexedEdges[item], x, y).distance;
+    });
+
+    std::vector<EdgeSnap> result;
+    for (const auto& pair : found) result.push_back(projectOnEdge(indexedEdges[pair.second], x, y));
+    return result;
+}
+
+template <class T>
+EdgeSnap SpatialIndex<T>::nearestEdge(double latitude, double longitude) const {
+    std::vector<EdgeSnap> found = nearestEdges(latitude, longitude, 1, INF);
+    return found.empty() ? EdgeSnap{-1, 0, INF} : found[0];
+}
+
+// points are snapped in chunks so that threads are not woken up per point
+const int SNAP_CHUNK = 1024;
+
+template <class T>
+std::vector<int> SpatialIndex<T>::snapToVertices(const std::vector<std::pair<double, double>>& points) const {
+    std::vector<int> result(points.size());
+    int chunks = (points.size() + SNAP_CHUNK - 1) / SNAP_CHUNK;
+    parallelFor(chunks, [&](int c, unsigned int) {
+        int last = std::min<int>(points.size(), (c + 1) * SNAP_CHUNK);
+        for (int i = c * SNAP_CHUNK; i < last; i++) result[i] = nearestVertex(points[i].first, points[i].second);
+    });
+    return result;
+}
+
+template <class T>
+std::vector<EdgeSnap> SpatialIndex<T>::snapToEdges(const std::vector<std::pair<double, double>>& points) const {
+    std::vector<EdgeSnap> result(points.size());
+    int chunks = (points.size() + SNAP_CHUNK - 1) / SNAP_CHUNK;
+    parallelFor(chunks, [&](int c, unsigned int) {
+        int last = std::min<int>(points.size(), (c + 1) * SNAP_CHUNK);
+        for (int i = c * SNAP_CHUNK; i < last; i++) result[i] = nearestEdge(points[i].first, points[i].second);
+    });
+    return result;
+}
+
+#endif
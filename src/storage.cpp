@@ -1,4 +1,16 @@
 #include "storage.hpp"
+#include "multisource.hpp"
+#include "deltastepping.hpp"
+#include "search.hpp"
+#include "bidirectional.hpp"
+#include "isochrone.hpp"
+#include "spatial.hpp"
+#include "mapmatching.hpp"
+#include "betweenness.hpp"
+#include "maxflow.hpp"
+#include "assignment.hpp"
+#include "fleet.hpp"
+#include "corridor.hpp"
 #include <limits>
 #include <stdexcept>
 #include <string>
@@ -6,11 +18,36 @@
 #include <fstream>
 #include <iostream>
 #include <regex>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
 
 bool isNumeric(const std::string& str) {
     return !str.empty() && std::all_of(str.begin(), str.end(), ::isdigit);
 }
 
+std::string trim(const std::string& str) {
+    size_t first = str.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) return "";
+    size_t last = str.find_last_not_of(" \t\r\n");
+    return str.substr(first, last - first + 1);
+}
+
+std::vector<std::string> splitFields(const std::string& line, char separator) {
+    std::vector<std::string> fields;
+    std::stringstream ss(line);
+    std::string field;
+    while (getline(ss, field, separator)) fields.push_back(trim(field));
+    return fields;
+}
+
+// position of an optional column, looked up by its header name (-1 if absent)
+int findColumn(const std::vector<std::string>& header, const std::string& name) {
+    auto it = std::find(header.begin(), header.end(), name);
+    return (it != header.end()) ? static_cast<int>(it - header.begin()) : -1;
+}
+
 void StorageHandler::loadLocations(const std::string& locationsFile) {
     std::ifstream file(locationsFile);
     if (!file.is_open()) {
@@ -18,7 +55,11 @@ void StorageHandler::loadLocations(const std::string& locationsFile) {
     }
 
     std::string line;
-    getline(file, line); // ignore file header
+    getline(file, line); // the first four columns are positional, extra ones are looked up by name
+    std::vector<std::string> header = splitFields(line, ',');
+    int tagsColumn = findColumn(header, "Tags");
+    int latitudeColumn = findColumn(header, "Latitude");
+    int longitudeColumn = findColumn(header, "Longitude");
     
     int linenumber = 2; // first data line is the second in file
     while (getline(file, line)) {
@@ -39,6 +80,28 @@ void StorageHandler::loadLocations(const std::string& locationsFile) {
             continue;
         }
         
+        std::vector<std::string> fields = splitFields(line, ',');
+        bool positioned = latitudeColumn != -1 && longitudeColumn != -1 &&
+                          std::max(latitudeColumn, longitudeColumn) < static_cast<int>(fields.size()) &&
+                          !fields[latitudeColumn].empty() && !fields[longitudeColumn].empty();
+        double latitude = 0, longitude = 0;
+        if (positioned) {
+            // checked before the vertex exists, a bad position must not leave it half loaded
+            bool valid = true;
+            try {
+                latitude = std::stod(fields[latitudeColumn]);
+                longitude = std::stod(fields[longitudeColumn]);
+            } catch (const std::exception& e) {
+                valid = false;
+            }
+            // the negated ranges also reject NaN
+            if (!valid || !(latitude >= -90 && latitude <= 90 && longitude >= -180 && longitude <= 180)) {
+                std::cerr << "Error: Invalid coordinates on line " << std::to_string(linenumber) << ": "
+                          << fields[latitudeColumn] << "," << fields[longitudeColumn] << "\n";
+                continue;
+            }
+        }
+
         try {
             int id = std::stoi(idStr);
             parkingStr.erase(std::remove_if(parkingStr.begin(), parkingStr.end(), ::isspace), parkingStr.end());
@@ -48,6 +111,13 @@ void StorageHandler::loadLocations(const std::string& locationsFile) {
             if (!cityGraph.addVertex(id, code, parking)) {
                 throw std::runtime_error("Error adding vertex for ID " + idStr + " on line "  + std::to_string(linenumber));
             }
+
+            if (tagsColumn != -1 && tagsColumn < static_cast<int>(fields.size())) {
+                for (const std::string& tag : splitFields(fields[tagsColumn], ';')) {
+                    if (!tag.empty()) cityGraph.findVertex(id)->addTag(tag);
+                }
+            }
+            if (positioned) cityGraph.findVertex(id)->setCoordinates(latitude, longitude);
         } catch (const std::invalid_argument& e) {
             std::cerr << "Error: Invalid ID format on line " << std::to_string(linenumber) << ": " << idStr << "\n";
             continue;
@@ -58,6 +128,7 @@ void StorageHandler::loadLocations(const std::string& locationsFile) {
     }
 
     file.close();
+    invalidateSnapshot();
     std::cout << "Locations loaded successfully!\n";
 }
 
@@ -68,7 +139,10 @@ void StorageHandler::loadRoads(const std::string& roadFile) {
     }
 
     std::string line;
-    getline(file, line); // ignore file header
+    getline(file, line); // file header; columns after the walking time are named profiles
+    std::vector<std::string> header = splitFields(line, ',');
+    std::vector<std::string> extraProfiles(header.begin() + std::min<size_t>(4, header.size()), header.end());
+    for (const std::string& profile : extraProfiles) profileWeights[profile].clear();
     
     int linenumber = 2; // first data line is the second in file
     while (getline(file, line)) {
@@ -108,6 +182,11 @@ void StorageHandler::loadRoads(const std::string& roadFile) {
             if (!cityGraph.addBidirectionalEdge(loc1, loc2, walking, driving)) {
                 throw std::runtime_error("Error adding road for ID " + loc1 + "<-> " + loc2 + " on line "  + std::to_string(linenumber));
             }
+
+            std::vector<std::string> extra = splitFields(line, ',');
+            for (size_t i = 0; i < extraProfiles.size() && i + 4 < extra.size(); i++) {
+                setProfileWeight(extraProfiles[i], loc1, loc2, extra[i + 4]);
+            }
         } catch (const std::invalid_argument& e) {
             std::cerr << "Error: Invalid format on line " << std::to_string(linenumber) << "\n";
             continue;
@@ -118,9 +197,352 @@ void StorageHandler::loadRoads(const std::string& roadFile) {
     }
 
     file.close();
+    invalidateSnapshot();
     std::cout << "Locations loaded successfully!\n";
 }
 
+/*
+ * Loads the weights of named profiles from a "loc1,loc2,<profile>[,<profile>...]" file,
+ * one column per profile, for roads already loaded (in both directions, X if impassable).
+ * Roads without a weight for a profile cannot be used by it.
+ */
+void StorageHandler::loadProfiles(const std::string& profilesFile) {
+    std::ifstream file(profilesFile);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open profiles file " + profilesFile);
+    }
+
+    std::string line;
+    getline(file, line);
+    std::vector<std::string> header = splitFields(line, ',');
+    if (header.size() < 3) {
+        throw std::runtime_error("Error: profiles file " + profilesFile + " has no profile column\n");
+    }
+    std::vector<std::string> profiles(header.begin() + 2, header.end());
+    for (const std::string& profile : profiles) profileWeights[profile].clear();
+
+    int linenumber = 2; // first data line is the second in file
+    while (getline(file, line)) {
+        linenumber++;
+        std::vector<std::string> fields = splitFields(line, ',');
+        if (fields.size() < 3 || fields[0].empty() || fields[1].empty()) {
+            std::cerr << "Warning: Skipping malformed line " << std::to_string(linenumber) << ": " << line << "\n";
+            continue;
+        }
+        try {
+            for (size_t i = 0; i < profiles.size() && i + 2 < fields.size(); i++) {
+                setProfileWeight(profiles[i], fields[0], fields[1], fields[i + 2]);
+            }
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Error: Invalid format on line " << std::to_string(linenumber) << "\n";
+        } catch (const std::exception& e) {
+            std::cerr << "Error processing line " << std::to_string(linenumber) << ": " << e.what() << "\n";
+        }
+    }
+
+    file.close();
+    invalidateSnapshot();
+    std::cout << "Profiles loaded successfully!\n";
+}
+
+void StorageHandler::setProfileWeight(const std::string& profile, const std::string& loc1, const std::string& loc2,
+                                      const std::string& weight) {
+    if (profile == "driving" || profile == "walking") {
+        throw std::runtime_error("Profile " + profile + " is built in");
+    }
+    Vertex<int>* v1 = isNumeric(loc1) ? cityGraph.findVertex(std::stoi(loc1)) : cityGraph.findVertex(loc1);
+    Vertex<int>* v2 = isNumeric(loc2) ? cityGraph.findVertex(std::stoi(loc2)) : cityGraph.findVertex(loc2);
+    if (v1 == nullptr || v2 == nullptr) {
+        throw std::runtime_error("Unknown location " + (v1 == nullptr ? loc1 : loc2));
+    }
+    double value = weight == "X" ? INF : std::stod(weight);
+    // every search over the profile column assumes non-negative weights
+    if (value < 0 || std::isnan(value)) {
+        throw std::runtime_error("Invalid " + profile + " weight " + weight);
+    }
+    profileWeights[profile][{v1->getInfo(), v2->getInfo()}] = value;
+    profileWeights[profile][{v2->getInfo(), v1->getInfo()}] = value;
+}
+
+/*
+ * Loads point-of-interest categories from a "Code,Category" file (ids are accepted too).
+ * A location can appear on several lines to get several categories.
+ */
+void StorageHandler::loadPointsOfInterest(const std::string& poiFile) {
+    std::ifstream file(poiFile);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open points of interest file " + poiFile);
+    }
+
+    std::string line;
+    getline(file, line); // ignore file header
+
+    int linenumber = 2; // first data line is the second in file
+    while (getline(file, line)) {
+        linenumber++;
+        std::vector<std::string> fields = splitFields(line, ',');
+        if (fields.size() < 2 || fields[0].empty() || fields[1].empty()) {
+            std::cerr << "Warning: Skipping malformed line " << std::to_string(linenumber) << ": " << line << "\n";
+            continue;
+        }
+
+        Vertex<int>* vert = isNumeric(fields[0]) ? cityGraph.findVertex(std::stoi(fields[0])) : cityGraph.findVertex(fields[0]);
+        if (vert == nullptr) {
+            std::cerr << "Warning: Skipping line " << std::to_string(linenumber) << " due to unknown location " << fields[0] << "\n";
+            continue;
+        }
+        vert->addTag(fields[1]);
+    }
+
+    file.close();
+    poiIndex.reset();
+    std::cout << "Points of interest loaded successfully!\n";
+}
+
+/*
+ * Loads a GTFS feed (stops.txt, stop_times.txt and optionally trips.txt) from a directory.
+ * Stops are linked to the road network the first time a transit route is asked for.
+ */
+void StorageHandler::loadTransitFeed(const std::string& gtfsDirectory) {
+    auto feed = std::make_unique<TransitTimetable>();
+    try {
+        feed->load(gtfsDirectory);
+    } catch (const std::exception& e) {
+        // a missing or broken feed keeps the one already loaded, if any
+        std::cerr << "Error loading transit feed: " << e.what() << "\n";
+        return;
+    }
+    timetable = std::move(feed);
+    transitRouter.reset();
+    std::cout << "Transit feed loaded successfully! (" << timetable->getNumStops() << " stops, "
+              << timetable->getNumRoutes() << " routes)\n";
+}
+
+TransitRouter<int>& StorageHandler::getTransitRouter() {
+    if (timetable == nullptr) {
+        throw std::runtime_error("Error: No transit feed loaded\n");
+    }
+    if (transitRouter == nullptr) {
+        transitRouter = std::make_unique<TransitRouter<int>>(getSnapshot(), getSpatialIndex(), *timetable, MAX_STOP_SNAP_DISTANCE);
+    }
+    return *transitRouter;
+}
+
+/*
+ * Loads turn costs from a "From,Via,To,Cost" file (codes or ids); a cost of X bans the turn.
+ * Turns not listed are free.
+ */
+void StorageHandler::loadTurns(const std::string& turnsFile) {
+    std::ifstream file(turnsFile);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open turns file " + turnsFile);
+    }
+
+    std::string line;
+    getline(file, line); // ignore file header
+
+    turnRules.clear();
+    int linenumber = 2; // first data line is the second in file
+    while (getline(file, line)) {
+        linenumber++;
+        std::vector<std::string> fields = splitFields(line, ',');
+        if (fields.size() < 4 || fields[0].empty() || fields[1].empty() || fields[2].empty()) {
+            std::cerr << "Warning: Skipping malformed line " << std::to_string(linenumber) << ": " << line << "\n";
+            continue;
+        }
+
+        int ids[3];
+        bool known = true;
+        for (int i = 0; i < 3; i++) {
+            Vertex<int>* vert = isNumeric(fields[i]) ? cityGraph.findVertex(std::stoi(fields[i])) : cityGraph.findVertex(fields[i]);
+            if (vert == nullptr) {
+                std::cerr << "Warning: Skipping line " << std::to_string(linenumber) << " due to unknown location " << fields[i] << "\n";
+                known = false;
+                break;
+            }
+            ids[i] = vert->getInfo();
+        }
+        if (!known) continue;
+
+        try {
+            double cost = fields[3] == "X" ? INF : std::stod(fields[3]);
+            // the edge-based search needs non-negative costs, a negative U-turn could even form a cycle
+            if (cost < 0 || std::isnan(cost)) throw std::invalid_argument("negative turn cost");
+            turnRules.push_back({ids[0], ids[1], ids[2], cost});
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Error: Invalid format on line " << std::to_string(linenumber) << "\n";
+        } catch (const std::exception& e) {
+            std::cerr << "Error processing line " << std::to_string(linenumber) << ": " << e.what() << "\n";
+        }
+    }
+
+    file.close();
+    turnTable.reset();
+    std::cout << "Turns loaded successfully!\n";
+}
+
+const TurnTable<int>& StorageHandler::getTurnTable() {
+    if (turnTable == nullptr) {
+        const CompactGraph<int>& graph = getSnapshot();
+        std::vector<TurnEntry> turns;
+        for (const auto& [from, via, to, cost] : turnRules) {
+            int fromIndex = graph.findIndex(from), viaIndex = graph.findIndex(via), toIndex = graph.findIndex(to);
+            if (fromIndex != -1 && viaIndex != -1 && toIndex != -1) turns.push_back({fromIndex, viaIndex, toIndex, cost});
+        }
+        turnTable = std::make_unique<TurnTable<int>>(graph, turns);
+        if (turnTable->getSkipped() > 0) {
+            std::cerr << "Warning: " << turnTable->getSkipped() << " turns do not match a pair of roads\n";
+        }
+    }
+    return *turnTable;
+}
+
+void StorageHandler::invalidateSnapshot() {
+    poiIndex.reset(); // these refer to the snapshot
+    spatialIndex.reset();
+    geometricBounds.clear();
+    arcFlags.clear();
+    overlayMetrics.clear(); // before the overlay they refer to
+    overlayGraph.reset();
+    transitNodes.clear();
+    reachBounds.clear();
+    distanceOracles.clear();
+    transitRouter.reset();
+    turnTable.reset();
+    routeSessions.clear();
+    routeSessionProfiles.clear();
+    snapshot.reset();
+}
+
+const GeometricBound<int>& StorageHandler::getGeometricBound(int profile) {
+    std::unique_ptr<GeometricBound<int>>& bound = geometricBounds[profile];
+    if (bound == nullptr) {
+        bound = std::make_unique<GeometricBound<int>>(getSnapshot(), profile);
+    }
+    return *bound;
+}
+
+ArcFlags<int>& StorageHandler::getArcFlags(int profile) {
+    std::unique_ptr<ArcFlags<int>>& flags = arcFlags[profile];
+    if (flags == nullptr) {
+        const CompactGraph<int>& graph = getSnapshot();
+        flags = std::make_unique<ArcFlags<int>>(graph, graph.getWeights(profile), ARC_FLAG_REGIONS);
+    }
+    return *flags;
+}
+
+const ReachBounds<int>& StorageHandler::getReachBounds(int profile) {
+    std::unique_ptr<ReachBounds<int>>& bounds = reachBounds[profile];
+    if (bounds == nullptr) {
+        const CompactGraph<int>& graph = getSnapshot();
+        bounds = std::make_unique<ReachBounds<int>>(graph, graph.getWeights(profile), REACH_BALL);
+    }
+    return *bounds;
+}
+
+/*
+ * Distance oracle of a profile: read from its file next to the data when that file was saved for
+ * the current snapshot and weights, otherwise built and saved there (when it can be written).
+ */
+DistanceOracle<int>& StorageHandler::getDistanceOracle(int profile) {
+    std::unique_ptr<DistanceOracle<int>>& oracle = distanceOracles[profile];
+    if (oracle == nullptr) {
+        const CompactGraph<int>& graph = getSnapshot();
+        std::string path = ORACLE_DIRECTORY + graph.getProfileName(profile) + ".oracle";
+        if (!DistanceOracle<int>::load(path, graph, graph.getWeights(profile), oracle)) {
+            oracle = std::make_unique<DistanceOracle<int>>(graph, graph.getWeights(profile), ORACLE_LANDMARKS);
+            try {
+                oracle->save(path);
+            } catch (const std::exception& e) {
+                // the file only saves the next run a rebuild, the oracle itself is fine
+                std::cerr << "Warning: " << e.what() << "\n";
+            }
+        }
+    }
+    return *oracle;
+}
+
+/*
+ * Customized overlay of a profile; the partition is shared by every profile and built on first
+ * use, with about OVERLAY_CELL_SIZE vertices per finest cell.
+ */
+OverlayMetric<int>& StorageHandler::getOverlayMetric(int profile) {
+    const CompactGraph<int>& graph = getSnapshot();
+    if (overlayGraph == nullptr) {
+        double cells = std::max(2.0, static_cast<double>(graph.getNumVertex()) / OVERLAY_CELL_SIZE);
+        int bits = std::max(1, static_cast<int>(std::round(std::log2(cells) / OVERLAY_LEVELS)));
+        overlayGraph = std::make_unique<OverlayGraph<int>>(graph, OVERLAY_LEVELS, bits);
+    }
+    std::unique_ptr<OverlayMetric<int>>& metric = overlayMetrics[profile];
+    if (metric == nullptr) {
+        metric = std::make_unique<OverlayMetric<int>>(*overlayGraph, graph.getWeights(profile));
+    }
+    return *metric;
+}
+
+/*
+ * Transit node table and access nodes of a profile, built on first use, with about
+ * TRANSIT_NODE_CELL_SIZE vertices per cell.
+ */
+TransitNodeRouting<int>& StorageHandler::getTransitNodes(int profile) {
+    std::unique_ptr<TransitNodeRouting<int>>& tnr = transitNodes[profile];
+    if (tnr == nullptr) {
+        const CompactGraph<int>& graph = getSnapshot();
+        int cells = std::max(2, graph.getNumVertex() / TRANSIT_NODE_CELL_SIZE);
+        tnr = std::make_unique<TransitNodeRouting<int>>(graph, graph.getWeights(profile), cells, TRANSIT_NODE_LIMIT);
+    }
+    return *tnr;
+}
+
+const SpatialIndex<int>& StorageHandler::getSpatialIndex() {
+    if (spatialIndex == nullptr) {
+        spatialIndex = std::make_unique<SpatialIndex<int>>(getSnapshot());
+    }
+    return *spatialIndex;
+}
+
+int StorageHandler::snapToVertex(const std::pair<double, double>& position) {
+    int index = getSpatialIndex().nearestVertex(position.first, position.second);
+    if (index == -1) {
+        throw std::runtime_error("Error: No location to snap to\n");
+    }
+    return getSnapshot().getInfo(index);
+}
+
+PoiIndex<int>& StorageHandler::getPoiIndex() {
+    if (poiIndex == nullptr) {
+        poiIndex = std::make_unique<PoiIndex<int>>(getSnapshot());
+    }
+    return *poiIndex;
+}
+
+const CompactGraph<int>& StorageHandler::getSnapshot() {
+    if (snapshot == nullptr) {
+        snapshot = std::make_unique<CompactGraph<int>>(cityGraph);
+        for (const auto& [profile, weights] : profileWeights) {
+            std::vector<double> column(snapshot->getNumEdges(), INF);
+            for (int e = 0; e < snapshot->getNumEdges(); e++) {
+                auto it = weights.find({snapshot->getInfo(snapshot->getTail(e)), snapshot->getInfo(snapshot->getHead(e))});
+                if (it != weights.end()) column[e] = it->second;
+            }
+            snapshot->addWeightColumn(profile, std::move(column));
+        }
+    }
+    return *snapshot;
+}
+
+int StorageHandler::parseProfile(const std::string& profile) {
+    int index = getSnapshot().findProfile(profile);
+    if (index == -1) {
+        throw std::runtime_error("Error: Unknown profile " + profile + "\n");
+    }
+    if (profile == CAPACITY_COLUMN) {
+        // loaded like a profile, but vehicles per hour are not travel times
+        throw std::runtime_error("Error: " + profile + " is not a travel-time profile\n");
+    }
+    return index;
+}
+
 void StorageHandler::callDijkstra(const std::string& src, const std::string& dest) {
     int source, destination;
     if (!isNumeric(src)) {
@@ -204,6 +626,10 @@ void StorageHandler::callRestrictedDijkstra(const std::string& src, const std::s
 void StorageHandler::calculateEnvironmentalRoute(int source, int destination, int maxWalkingTime, std::vector<int> avoidNodes, std::vector<std::pair<int,int>> avoidSegments) {
     std::ofstream file("../output.txt");
 
+    // taken before the exclusions below, so they do not end up in the cached snapshot
+    std::vector<Vertex<int>*> parkingVertices;
+    for (int v : getPoiIndex().getVertices(PARKING_CATEGORY)) parkingVertices.push_back(getSnapshot().getVertex(v));
+
     // exclude requested nodes
     for (auto node : avoidNodes) {
         Vertex<int>* vert = cityGraph.findVertex(node);
@@ -230,7 +656,6 @@ void StorageHandler::calculateEnvironmentalRoute(int source, int destination, in
     }
 
 
-    std::vector<Vertex<int>*> parkingVertices = cityGraph.getAllParkingVertices();
     std::vector<std::tuple<double, std::vector<Edge<int>*>, std::vector<Edge<int>*>, int>> candidates;
     std::vector<std::tuple<double, double, std::vector<Edge<int>*>, std::vector<Edge<int>*>, int>> approxCandidates;
 
@@ -399,6 +824,1123 @@ void StorageHandler::calculateEnvironmentalRoute(int source, int destination, in
     return;
 }
 
+void StorageHandler::calculateDistanceTable(const std::vector<int>& sources, const std::string& profile) {
+    std::ofstream file("../output.txt");
+    const CompactGraph<int>& graph = getSnapshot();
+
+    std::vector<int> sourceIndexes;
+    for (int source : sources) {
+        int index = graph.findIndex(source);
+        if (index == -1) {
+            throw std::runtime_error("Error: Vertex with id " + std::to_string(source) + " not found!\n");
+        }
+        sourceIndexes.push_back(index);
+    }
+
+    std::vector<std::vector<double>> table = multiSourceDistances(graph, sourceIndexes, parseProfile(profile));
+
+    for (size_t i = 0; i < sources.size(); i++) {
+        std::cout << "Source:" << sources[i] << "\n";
+        file << "Source:" << sources[i] << "\n";
+        std::cout << "Distances:";
+        file << "Distances:";
+        bool first = true;
+        for (int v = 0; v < graph.getNumVertex(); v++) {
+            if (table[i][v] == INF) continue; // unreachable
+            if (!first) {std::cout << ","; file << ",";}
+            std::cout << graph.getInfo(v) << "(" << table[i][v] << ")";
+            file << graph.getInfo(v) << "(" << table[i][v] << ")";
+            first = false;
+        }
+        std::cout << "\n";
+        file << "\n";
+    }
+    file.close();
+}
+
+/*
+ * Fastest route for a profile with the unified search, which is goal-directed (A*)
+ * whenever the locations have coordinates.
+ */
+void StorageHandler::calculateRoute(int source, int destination, const std::string& profile) {
+    std::ofstream file("../output.txt");
+    const CompactGraph<int>& graph = getSnapshot();
+    int sourceIndex = graph.findIndex(source);
+    int destIndex = graph.findIndex(destination);
+    if (sourceIndex == -1 || destIndex == -1) {
+        throw std::runtime_error("Error: Vertex with id " + std::to_string(sourceIndex == -1 ? source : destination) + " not found!\n");
+    }
+
+    int profileIndex = parseProfile(profile);
+    SearchWorkspace ws;
+    double dist = fastestPath(graph, profileIndex, getGeometricBound(profileIndex), sourceIndex, destIndex, ws);
+
+    std::cout << "Source:" << source << "\n";
+    std::cout << "Destination:" << destination << "\n";
+    file << "Source:" << source << "\n";
+    file << "Destination:" << destination << "\n";
+    if (dist == INF) {
+        std::cout << "Route:none\n";
+        file << "Route:none\n";
+        file.close();
+        return;
+    }
+
+    std::cout << "Route:";
+    file << "Route:";
+    for (int e : extractPath(graph, ws, destIndex)) {std::cout << graph.getInfo(graph.getTail(e)) << ","; file << graph.getInfo(graph.getTail(e)) << ",";}
+    std::cout << destination << "(" << dist << ")\n";
+    file << destination << "(" << dist << ")\n";
+    file.close();
+}
+
+/*
+ * Driving route that pays turn costs and respects banned turns (see loadTurns).
+ */
+void StorageHandler::calculateTurnRoute(int source, int destination) {
+    std::ofstream file("../output.txt");
+    const CompactGraph<int>& graph = getSnapshot();
+    int sourceIndex = graph.findIndex(source);
+    int destIndex = graph.findIndex(destination);
+    if (sourceIndex == -1 || destIndex == -1) {
+        throw std::runtime_error("Error: Vertex with id " + std::to_string(sourceIndex == -1 ? source : destination) + " not found!\n");
+    }
+
+    const TurnTable<int>& turns = getTurnTable();
+    const GeometricBound<int>& bound = getGeometricBound(DRIVING);
+    SearchWorkspace ws;
+    int lastEdge;
+    double dist = bound.isAvailable()
+        ? shortestTurnPath(graph, graph.getWeights(DRIVING), turns, sourceIndex, destIndex, ws, lastEdge,
+                           [&](int v) { return bound.lowerBound(v, destIndex); })
+        : shortestTurnPath(graph, graph.getWeights(DRIVING), turns, sourceIndex, destIndex, ws, lastEdge);
+
+    std::cout << "Source:" << source << "\n";
+    std::cout << "Destination:" << destination << "\n";
+    file << "Source:" << source << "\n";
+    file << "Destination:" << destination << "\n";
+    if (dist == INF) {
+        std::cout << "Route:none\n";
+        file << "Route:none\n";
+        file.close();
+        return;
+    }
+
+    std::cout << "Route:";
+    file << "Route:";
+    for (int e : extractTurnPath(ws, lastEdge)) {std::cout << graph.getInfo(graph.getTail(e)) << ","; file << graph.getInfo(graph.getTail(e)) << ",";}
+    std::cout << destination << "(" << dist << ")\n";
+    file << destination << "(" << dist << ")\n";
+    file.close();
+}
+
+void StorageHandler::calculateBidirectionalRoute(int source, int destination, const std::string& profile, bool parallel) {
+    std::ofstream file("../output.txt");
+    const CompactGraph<int>& graph = getSnapshot();
+    int sourceIndex = graph.findIndex(source);
+    int destIndex = graph.findIndex(destination);
+    if (sourceIndex == -1 || destIndex == -1) {
+        throw std::runtime_error("Error: Vertex with id " + std::to_string(sourceIndex == -1 ? source : destination) + " not found!\n");
+    }
+
+    BidirectionalSearch<int> search(graph, parseProfile(profile));
+    double dist = search.run(sourceIndex, destIndex, parallel);
+
+    std::cout << "Source:" << source << "\n";
+    std::cout << "Destination:" << destination << "\n";
+    file << "Source:" << source << "\n";
+    file << "Destination:" << destination << "\n";
+    if (dist == INF) {
+        std::cout << "Route:none\n";
+        file << "Route:none\n";
+        file.close();
+        return;
+    }
+
+    std::cout << "Route:";
+    file << "Route:";
+    for (int e : search.getPath()) {std::cout << graph.getInfo(graph.getTail(e)) << ","; file << graph.getInfo(graph.getTail(e)) << ",";}
+    std::cout << destination << "(" << dist << ")\n";
+    file << destination << "(" << dist << ")\n";
+    file.close();
+}
+
+void StorageHandler::calculateIsochrones(const std::vector<int>& origins, double maxTime, const std::string& mode) {
+    std::ofstream file("../output.txt");
+    const CompactGraph<int>& graph = getSnapshot();
+
+    IsochroneMode isoMode;
+    if (mode == "isochrone-driving") isoMode = ISOCHRONE_DRIVING;
+    else if (mode == "isochrone-walking") isoMode = ISOCHRONE_WALKING;
+    else isoMode = ISOCHRONE_DRIVING_WALKING;
+
+    if (maxTime < 0) {
+        throw std::runtime_error("Error: Isochrones need a MaxTime\n");
+    }
+
+    std::vector<int> originIndexes;
+    for (int origin : origins) {
+        int index = graph.findIndex(origin);
+        if (index == -1) {
+            throw std::runtime_error("Error: Vertex with id " + std::to_string(origin) + " not found!\n");
+        }
+        originIndexes.push_back(index);
+    }
+
+    std::vector<Isochrone> isochrones = computeIsochrones(graph, originIndexes, maxTime, isoMode);
+
+    for (size_t i = 0; i < origins.size(); i++) {
+        std::cout << "Source:" << origins[i] << "\n";
+        file << "Source:" << origins[i] << "\n";
+
+        std::cout << "Reachable:";
+        file << "Reachable:";
+        bool first = true;
+        isochrones[i].reached.forEach([&](int v) {
+            if (!first) {std::cout << ","; file << ",";}
+            std::cout << graph.getInfo(v);
+            file << graph.getInfo(v);
+            first = false;
+        });
+        std::cout << "\n";
+        file << "\n";
+
+        std::cout << "Boundary:";
+        file << "Boundary:";
+        for (const BoundaryEdge& b : isochrones[i].boundary) {
+            int tail = graph.getInfo(graph.getTail(b.edge));
+            int head = graph.getInfo(graph.getHead(b.edge));
+            std::cout << "(" << tail << "," << head << "," << b.fraction << ")";
+            file << "(" << tail << "," << head << "," << b.fraction << ")";
+        }
+        std::cout << "\n";
+        file << "\n";
+    }
+    file.close();
+}
+
+/*
+ * k closest points of interest of a category. Lists of the POI_CANDIDATES closest ones
+ * are precomputed per vertex the first time a category is queried with a profile.
+ */
+void StorageHandler::calculateNearestPoi(int source, const std::string& category, int k, const std::string& profile) {
+    std::ofstream file("../output.txt");
+    const CompactGraph<int>& graph = getSnapshot();
+    int sourceIndex = graph.findIndex(source);
+    if (sourceIndex == -1) {
+        throw std::runtime_error("Error: Vertex with id " + std::to_string(source) + " not found!\n");
+    }
+
+    PoiIndex<int>& index = getPoiIndex();
+    int profileIndex = parseProfile(profile);
+    if (!index.hasCandidates(category, profileIndex)) index.precompute(category, profileIndex, POI_CANDIDATES);
+
+    SearchWorkspace ws;
+    std::vector<std::pair<int, double>> pois = index.nearest(sourceIndex, category, k, profileIndex, ws);
+
+    std::cout << "Source:" << source << "\n";
+    std::cout << "Category:" << category << "\n";
+    file << "Source:" << source << "\n";
+    file << "Category:" << category << "\n";
+    std::cout << "Nearest:";
+    file << "Nearest:";
+    if (pois.empty()) {std::cout << "none"; file << "none";}
+    for (size_t i = 0; i < pois.size(); i++) {
+        if (i > 0) {std::cout << ","; file << ",";}
+        std::cout << graph.getInfo(pois[i].first) << "(" << pois[i].second << ")";
+        file << graph.getInfo(pois[i].first) << "(" << pois[i].second << ")";
+    }
+    std::cout << "\n";
+    file << "\n";
+    file.close();
+}
+
+/*
+ * Snaps GPS positions to their nearest location and nearest road segment.
+ */
+void StorageHandler::snapPositions(const std::vector<std::pair<double, double>>& positions) {
+    std::ofstream file("../output.txt");
+    const CompactGraph<int>& graph = getSnapshot();
+    const SpatialIndex<int>& index = getSpatialIndex();
+
+    std::vector<int> vertices = index.snapToVertices(positions);
+    std::vector<EdgeSnap> edges = index.snapToEdges(positions);
+
+    for (size_t i = 0; i < positions.size(); i++) {
+        std::cout << "Position:" << positions[i].first << "," << positions[i].second << "\n";
+        std::cout << "NearestNode:" << graph.getInfo(vertices[i]) << "\n";
+        file << "Position:" << positions[i].first << "," << positions[i].second << "\n";
+        file << "NearestNode:" << graph.getInfo(vertices[i]) << "\n";
+        if (edges[i].edge == -1) {
+            std::cout << "NearestSegment:none\n";
+            file << "NearestSegment:none\n";
+            continue;
+        }
+        int tail = graph.getInfo(graph.getTail(edges[i].edge));
+        int head = graph.getInfo(graph.getHead(edges[i].edge));
+        std::cout << "NearestSegment:(" << tail << "," << head << "," << edges[i].fraction << ")(" << edges[i].distance << "m)\n";
+        file << "NearestSegment:(" << tail << "," << head << "," << edges[i].fraction << ")(" << edges[i].distance << "m)\n";
+    }
+    file.close();
+}
+
+/*
+ * Map-matches the GPS traces of a "TraceId,Latitude,Longitude" file (points of a trace
+ * in driving order) and prints the driven locations of each one.
+ */
+void StorageHandler::matchTraces(const std::string& traceFile) {
+    std::ifstream input(traceFile);
+    if (!input.is_open()) {
+        throw std::runtime_error("Could not open traces file " + traceFile);
+    }
+
+    std::vector<std::string> traceIds;
+    std::vector<std::vector<GpsPoint>> traces;
+    std::unordered_map<std::string, int> traceIndex;
+
+    std::string line;
+    getline(input, line); // ignore file header
+    int linenumber = 2; // first data line is the second in file
+    while (getline(input, line)) {
+        linenumber++;
+        std::vector<std::string> fields = splitFields(line, ',');
+        if (fields.size() < 3 || fields[0].empty()) {
+            std::cerr << "Warning: Skipping malformed line " << std::to_string(linenumber) << ": " << line << "\n";
+            continue;
+        }
+        try {
+            GpsPoint point{std::stod(fields[1]), std::stod(fields[2])};
+            auto it = traceIndex.find(fields[0]);
+            if (it == traceIndex.end()) {
+                it = traceIndex.insert({fields[0], static_cast<int>(traces.size())}).first;
+                traceIds.push_back(fields[0]);
+                traces.push_back({});
+            }
+            traces[it->second].push_back(point);
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Error: Invalid format on line " << std::to_string(linenumber) << "\n";
+        }
+    }
+    input.close();
+
+    const CompactGraph<int>& graph = getSnapshot();
+    MapMatcher<int> matcher(graph, getSpatialIndex());
+    std::vector<MatchedTrace> matched = matcher.matchAll(traces);
+
+    std::ofstream file("../output.txt");
+    for (size_t i = 0; i < traces.size(); i++) {
+        std::cout << "Trace:" << traceIds[i] << "\n";
+        file << "Trace:" << traceIds[i] << "\n";
+        std::cout << "MatchedRoute:";
+        file << "MatchedRoute:";
+        if (matched[i].edges.empty()) {std::cout << "none"; file << "none";}
+        for (size_t j = 0; j < matched[i].edges.size(); j++) {
+            int e = matched[i].edges[j];
+            if (j == 0) {std::cout << graph.getInfo(graph.getTail(e)); file << graph.getInfo(graph.getTail(e));}
+            std::cout << "," << graph.getInfo(graph.getHead(e));
+            file << "," << graph.getInfo(graph.getHead(e));
+        }
+        std::cout << "\n";
+        file << "\n";
+        std::cout << "Breaks:" << matched[i].breaks << "\n";
+        file << "Breaks:" << matched[i].breaks << "\n";
+    }
+    file.close();
+}
+
+/*
+ * Maximum flow from the source zone to the sink zone (ids) over the road capacities, with the
+ * segments of a minimum cut, i.e. the bottleneck that limits it. The flow of every road is also
+ * stored on its edge.
+ */
+void StorageHandler::calculateMaxFlow(const std::vector<int>& sources, const std::vector<int>& sinks) {
+    const CompactGraph<int>& graph = getSnapshot();
+    int capacity = graph.findProfile(CAPACITY_COLUMN);
+    if (capacity == -1) {
+        throw std::runtime_error("Error: No road capacities loaded!\n");
+    }
+
+    auto toIndices = [&](const std::vector<int>& ids) {
+        std::vector<int> indices;
+        for (int id : ids) {
+            int v = graph.findIndex(id);
+            if (v == -1) {
+                throw std::runtime_error("Error: Vertex with id " + std::to_string(id) + " not found!\n");
+            }
+            indices.push_back(v);
+        }
+        return indices;
+    };
+    FlowQuery query{toIndices(sources), toIndices(sinks)};
+
+    MaxFlow<int> engine(graph, graph.getWeights(capacity));
+    MaxFlowResult result = engine.run(query);
+    for (int e = 0; e < graph.getNumEdges(); e++) graph.getEdge(e)->setFlow(result.flow[e]);
+
+    std::ofstream file("../output.txt");
+    std::cout << "MaxFlow:" << result.value << "\n";
+    file << "MaxFlow:" << result.value << "\n";
+    for (int e : result.cut) {
+        std::cout << "CutSegment:" << graph.getInfo(graph.getTail(e)) << "," << graph.getInfo(graph.getHead(e)) << "(" << result.flow[e] << ")\n";
+        file << "CutSegment:" << graph.getInfo(graph.getTail(e)) << "," << graph.getInfo(graph.getHead(e)) << "(" << result.flow[e] << ")\n";
+    }
+    file.close();
+}
+
+/*
+ * Betweenness of every road segment and location, highest first. With samples > 0 the
+ * scores are estimated from that many random sources, and the error bound is printed.
+ */
+void StorageHandler::calculateBetweenness(const std::string& profile, int samples) {
+    const CompactGraph<int>& graph = getSnapshot();
+    Betweenness scores = computeBetweenness(graph, parseProfile(profile), samples);
+
+    std::vector<int> edges(graph.getNumEdges()), vertices(graph.getNumVertex());
+    std::iota(edges.begin(), edges.end(), 0);
+    std::iota(vertices.begin(), vertices.end(), 0);
+    std::stable_sort(edges.begin(), edges.end(), [&](int a, int b) { return scores.edge[a] > scores.edge[b]; });
+    std::stable_sort(vertices.begin(), vertices.end(), [&](int a, int b) { return scores.vertex[a] > scores.vertex[b]; });
+
+    std::ofstream file("../output.txt");
+    std::cout << "Sources:" << scores.sources << "\n";
+    file << "Sources:" << scores.sources << "\n";
+    std::cout << "ErrorBound:" << scores.errorBound << "\n";
+    file << "ErrorBound:" << scores.errorBound << "\n";
+    for (int e : edges) {
+        std::cout << "Segment:" << graph.getInfo(graph.getTail(e)) << "," << graph.getInfo(graph.getHead(e)) << "(" << scores.edge[e] << ")\n";
+        file << "Segment:" << graph.getInfo(graph.getTail(e)) << "," << graph.getInfo(graph.getHead(e)) << "(" << scores.edge[e] << ")\n";
+    }
+    for (int v : vertices) {
+        std::cout << "Location:" << graph.getInfo(v) << "(" << scores.vertex[v] << ")\n";
+        file << "Location:" << graph.getInfo(v) << "(" << scores.vertex[v] << ")\n";
+    }
+    file.close();
+}
+
+/*
+ * Reads an "Origin,Destination[,Trips]" demand file (codes or ids) into snapshot indices.
+ */
+std::vector<Demand> StorageHandler::loadDemand(const std::string& demandFile) {
+    std::ifstream input(demandFile);
+    if (!input.is_open()) {
+        throw std::runtime_error("Could not open demand file " + demandFile);
+    }
+
+    const CompactGraph<int>& graph = getSnapshot();
+    std::vector<Demand> demand;
+    std::string line;
+    getline(input, line); // ignore file header
+    int linenumber = 2; // first data line is the second in file
+    while (getline(input, line)) {
+        linenumber++;
+        std::vector<std::string> fields = splitFields(line, ',');
+        if (fields.size() < 2 || fields[0].empty() || fields[1].empty()) {
+            std::cerr << "Warning: Skipping malformed line " << std::to_string(linenumber) << ": " << line << "\n";
+            continue;
+        }
+        Vertex<int>* origin = isNumeric(fields[0]) ? cityGraph.findVertex(std::stoi(fields[0])) : cityGraph.findVertex(fields[0]);
+        Vertex<int>* destination = isNumeric(fields[1]) ? cityGraph.findVertex(std::stoi(fields[1])) : cityGraph.findVertex(fields[1]);
+        if (origin == nullptr || destination == nullptr) {
+            std::cerr << "Warning: Skipping line " << std::to_string(linenumber) << " due to unknown location\n";
+            continue;
+        }
+        try {
+            double trips = fields.size() > 2 && !fields[2].empty() ? std::stod(fields[2]) : 1;
+            demand.push_back({graph.findIndex(origin->getInfo()), graph.findIndex(destination->getInfo()), trips});
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Error: Invalid format on line " << std::to_string(linenumber) << "\n";
+        }
+    }
+    input.close();
+    return demand;
+}
+
+/*
+ * Distance through the transit node table of the profile (built on first use). Query says whether
+ * the locality filter sent it to a plain search or to the table, and Lookups how many table
+ * entries it read.
+ */
+void StorageHandler::calculateTransitNodeDistance(int source, int destination, const std::string& profile) {
+    const CompactGraph<int>& graph = getSnapshot();
+    int sourceIndex = graph.findIndex(source);
+    int destIndex = graph.findIndex(destination);
+    if (sourceIndex == -1 || destIndex == -1) {
+        throw std::runtime_error("Error: Vertex with id " + std::to_string(sourceIndex == -1 ? source : destination) + " not found!\n");
+    }
+
+    TransitNodeRouting<int>& tnr = getTransitNodes(parseProfile(profile));
+    SearchWorkspace ws;
+    double dist = tnr.distance(sourceIndex, destIndex, ws);
+    std::string query = tnr.isLocal(sourceIndex, destIndex) ? "local" : "table";
+
+    std::ofstream file("../output.txt");
+    std::cout << "Source:" << source << "\n";
+    std::cout << "Destination:" << destination << "\n";
+    file << "Source:" << source << "\n";
+    file << "Destination:" << destination << "\n";
+    if (dist == INF) {
+        std::cout << "Distance:none\n";
+        file << "Distance:none\n";
+    } else {
+        std::cout << "Distance:" << dist << "\n";
+        file << "Distance:" << dist << "\n";
+    }
+    std::cout << "Query:" << query << "\n";
+    std::cout << "Lookups:" << tnr.getLookups() << "\n";
+    file << "Query:" << query << "\n";
+    file << "Lookups:" << tnr.getLookups() << "\n";
+    file.close();
+}
+
+/*
+ * Point-to-point route over the multi-level overlay of the profile (customized on first use).
+ * Settled shows the search effort, clique unpacking excluded.
+ */
+void StorageHandler::calculateOverlayRoute(int source, int destination, const std::string& profile) {
+    const CompactGraph<int>& graph = getSnapshot();
+    int sourceIndex = graph.findIndex(source);
+    int destIndex = graph.findIndex(destination);
+    if (sourceIndex == -1 || destIndex == -1) {
+        throw std::runtime_error("Error: Vertex with id " + std::to_string(sourceIndex == -1 ? source : destination) + " not found!\n");
+    }
+
+    OverlayMetric<int>& metric = getOverlayMetric(parseProfile(profile));
+    std::vector<int> path;
+    double dist = metric.query(sourceIndex, destIndex, path);
+
+    std::ofstream file("../output.txt");
+    std::cout << "Source:" << source << "\n";
+    std::cout << "Destination:" << destination << "\n";
+    file << "Source:" << source << "\n";
+    file << "Destination:" << destination << "\n";
+    if (dist == INF) {
+        std::cout << "Route:none\n";
+        file << "Route:none\n";
+    } else {
+        std::cout << "Route:";
+        file << "Route:";
+        for (int e : path) {std::cout << graph.getInfo(graph.getTail(e)) << ","; file << graph.getInfo(graph.getTail(e)) << ",";}
+        std::cout << destination << "(" << dist << ")\n";
+        file << destination << "(" << dist << ")\n";
+    }
+    std::cout << "Settled:" << metric.getSettled() << "\n";
+    file << "Settled:" << metric.getSettled() << "\n";
+    file.close();
+}
+
+/*
+ * Estimated travel times from every source to every destination, each within stretch times the
+ * real one. Fallbacks counts the pairs the landmarks could not bound tightly enough, which were
+ * answered by an exact search instead.
+ */
+void StorageHandler::calculateOracleEstimates(const std::vector<int>& sources, const std::vector<int>& destinations,
+                                              const std::string& profile, double stretch) {
+    if (stretch < 1) {
+        throw std::runtime_error("Error: Stretch must be at least 1!\n");
+    }
+    const CompactGraph<int>& graph = getSnapshot();
+    std::vector<int> sourceIndexes, destIndexes;
+    for (int source : sources) {
+        int index = graph.findIndex(source);
+        if (index == -1) {
+            throw std::runtime_error("Error: Vertex with id " + std::to_string(source) + " not found!\n");
+        }
+        sourceIndexes.push_back(index);
+    }
+    for (int destination : destinations) {
+        int index = graph.findIndex(destination);
+        if (index == -1) {
+            throw std::runtime_error("Error: Vertex with id " + std::to_string(destination) + " not found!\n");
+        }
+        destIndexes.push_back(index);
+    }
+
+    DistanceOracle<int>& oracle = getDistanceOracle(parseProfile(profile));
+    int fallbacks = oracle.getFallbacks();
+    SearchWorkspace ws;
+
+    std::ofstream file("../output.txt");
+    for (size_t i = 0; i < sources.size(); i++) {
+        std::cout << "Source:" << sources[i] << "\n";
+        file << "Source:" << sources[i] << "\n";
+        std::cout << "Estimates:";
+        file << "Estimates:";
+        for (size_t j = 0; j < destinations.size(); j++) {
+            double estimate = oracle.estimate(sourceIndexes[i], destIndexes[j], stretch, ws);
+            if (j > 0) {std::cout << ","; file << ",";}
+            std::cout << destinations[j] << "(";
+            file << destinations[j] << "(";
+            if (estimate == INF) {std::cout << "none"; file << "none";}
+            else {std::cout << estimate; file << estimate;}
+            std::cout << ")";
+            file << ")";
+        }
+        std::cout << "\n";
+        file << "\n";
+    }
+    std::cout << "Fallbacks:" << oracle.getFallbacks() - fallbacks << "\n";
+    file << "Fallbacks:" << oracle.getFallbacks() - fallbacks << "\n";
+    file.close();
+}
+
+/*
+ * Point-to-point A* route pruned by reach (bounds built on first use for the profile). The lower
+ * bound on the way left is the geometric one, so without coordinates nothing can be pruned and
+ * this is plain Dijkstra. Settled shows the search effort.
+ */
+void StorageHandler::calculateReachRoute(int source, int destination, const std::string& profile) {
+    const CompactGraph<int>& graph = getSnapshot();
+    int sourceIndex = graph.findIndex(source);
+    int destIndex = graph.findIndex(destination);
+    if (sourceIndex == -1 || destIndex == -1) {
+        throw std::runtime_error("Error: Vertex with id " + std::to_string(sourceIndex == -1 ? source : destination) + " not found!\n");
+    }
+
+    int profileIndex = parseProfile(profile);
+    const ReachBounds<int>& reach = getReachBounds(profileIndex);
+    const GeometricBound<int>& bound = getGeometricBound(profileIndex);
+    SearchWorkspace ws;
+    double dist = reach.shortestPath(sourceIndex, destIndex, ws, [&](int v) {
+        return bound.isAvailable() ? bound.lowerBound(v, destIndex) : 0.0;
+    });
+
+    std::ofstream file("../output.txt");
+    std::cout << "Source:" << source << "\n";
+    std::cout << "Destination:" << destination << "\n";
+    file << "Source:" << source << "\n";
+    file << "Destination:" << destination << "\n";
+    if (dist == INF) {
+        std::cout << "Route:none\n";
+        file << "Route:none\n";
+    } else {
+        std::cout << "Route:";
+        file << "Route:";
+        for (int e : extractPath(graph, ws, destIndex)) {std::cout << graph.getInfo(graph.getTail(e)) << ","; file << graph.getInfo(graph.getTail(e)) << ",";}
+        std::cout << destination << "(" << dist << ")\n";
+        file << destination << "(" << dist << ")\n";
+    }
+    std::cout << "Settled:" << ws.order.size() << "\n";
+    file << "Settled:" << ws.order.size() << "\n";
+    file.close();
+}
+
+/*
+ * Point-to-point route pruned by arc flags (built on first use for the profile), with the
+ * geometric bound as A* heuristic when there are coordinates. Settled shows the search effort.
+ */
+void StorageHandler::calculateArcFlagsRoute(int source, int destination, const std::string& profile) {
+    const CompactGraph<int>& graph = getSnapshot();
+    int sourceIndex = graph.findIndex(source);
+    int destIndex = graph.findIndex(destination);
+    if (sourceIndex == -1 || destIndex == -1) {
+        throw std::runtime_error("Error: Vertex with id " + std::to_string(sourceIndex == -1 ? source : destination) + " not found!\n");
+    }
+
+    int profileIndex = parseProfile(profile);
+    const ArcFlags<int>& flags = getArcFlags(profileIndex);
+    const GeometricBound<int>& bound = getGeometricBound(profileIndex);
+    SearchWorkspace ws;
+    double dist = bound.isAvailable()
+        ? flags.shortestPath(sourceIndex, destIndex, ws, [&](int v) { return bound.lowerBound(v, destIndex); })
+        : flags.shortestPath(sourceIndex, destIndex, ws);
+
+    std::ofstream file("../output.txt");
+    std::cout << "Source:" << source << "\n";
+    std::cout << "Destination:" << destination << "\n";
+    file << "Source:" << source << "\n";
+    file << "Destination:" << destination << "\n";
+    if (dist == INF) {
+        std::cout << "Route:none\n";
+        file << "Route:none\n";
+    } else {
+        std::cout << "Route:";
+        file << "Route:";
+        for (int e : extractPath(graph, ws, destIndex)) {std::cout << graph.getInfo(graph.getTail(e)) << ","; file << graph.getInfo(graph.getTail(e)) << ",";}
+        std::cout << destination << "(" << dist << ")\n";
+        file << destination << "(" << dist << ")\n";
+    }
+    std::cout << "Settled:" << ws.order.size() << "\n";
+    file << "Settled:" << ws.order.size() << "\n";
+    file.close();
+}
+
+/*
+ * Routes from source to destination in a new route session and prints its handle, which
+ * later re-route requests pass back with the driver's current vertex.
+ */
+void StorageHandler::startRouteSession(int source, int destination, const std::string& profile) {
+    const CompactGraph<int>& graph = getSnapshot();
+    int destIndex = graph.findIndex(destination);
+    if (destIndex == -1) {
+        throw std::runtime_error("Error: Vertex with id " + std::to_string(destination) + " not found!\n");
+    }
+    int profileIndex = parseProfile(profile);
+    routeSessions.push_back(std::make_unique<RouteSession<int>>(graph, graph.getWeights(profileIndex), destIndex));
+    routeSessionProfiles.push_back(profileIndex);
+    reroute(routeSessions.size() - 1, source, {});
+}
+
+/*
+ * Route from the current vertex to the destination of a route session, after closing the given
+ * segments (both directions). Reuses the session's search towards the destination, so only the
+ * vertices it had not reached yet are searched; Settled counts them.
+ */
+void StorageHandler::reroute(int handle, int current, const std::vector<std::pair<int, int>>& closures) {
+    if (handle < 0 || handle >= static_cast<int>(routeSessions.size())) {
+        throw std::runtime_error("Error: Unknown route session " + std::to_string(handle) + "\n");
+    }
+    if (routeSessions[handle] == nullptr) {
+        throw std::runtime_error("Error: Route session " + std::to_string(handle) + " ended by a traffic update\n");
+    }
+    const CompactGraph<int>& graph = getSnapshot();
+    RouteSession<int>& session = *routeSessions[handle];
+    int currentIndex = graph.findIndex(current);
+    if (currentIndex == -1) {
+        throw std::runtime_error("Error: Vertex with id " + std::to_string(current) + " not found!\n");
+    }
+
+    std::vector<int> closed;
+    for (const auto& [a, b] : closures) {
+        int u = graph.findIndex(a), v = graph.findIndex(b);
+        if (u == -1 || v == -1) {
+            throw std::runtime_error("Error: Vertex with id " + std::to_string(u == -1 ? a : b) + " not found!\n");
+        }
+        for (int e = graph.edgesBegin(u); e < graph.edgesEnd(u); e++) {
+            if (graph.getHead(e) == v) closed.push_back(e);
+        }
+        for (int e = graph.edgesBegin(v); e < graph.edgesEnd(v); e++) {
+            if (graph.getHead(e) == u) closed.push_back(e);
+        }
+    }
+    if (!closed.empty()) session.close(closed);
+
+    int settledBefore = session.getSettled();
+    std::vector<int> path;
+    double dist = session.route(currentIndex, path);
+
+    std::ofstream file("../output.txt");
+    std::cout << "Handle:" << handle << "\n";
+    file << "Handle:" << handle << "\n";
+    std::cout << "Source:" << current << "\n";
+    std::cout << "Destination:" << graph.getInfo(session.getTarget()) << "\n";
+    file << "Source:" << current << "\n";
+    file << "Destination:" << graph.getInfo(session.getTarget()) << "\n";
+    if (dist == INF) {
+        std::cout << "Route:none\n";
+        file << "Route:none\n";
+    } else {
+        std::cout << "Route:";
+        file << "Route:";
+        for (int e : path) {std::cout << graph.getInfo(graph.getTail(e)) << ","; file << graph.getInfo(graph.getTail(e)) << ",";}
+        std::cout << graph.getInfo(session.getTarget()) << "(" << dist << ")\n";
+        file << graph.getInfo(session.getTarget()) << "(" << dist << ")\n";
+    }
+    std::cout << "Settled:" << session.getSettled() - settledBefore << "\n";
+    file << "Settled:" << session.getSettled() - settledBefore << "\n";
+    file.close();
+}
+
+/*
+ * Parking near the driving route from source to destination: every parking whose detour from
+ * the route plus the walk to the destination is within detourBudget (MaxTime), best first.
+ */
+void StorageHandler::calculateCorridorParking(int source, int destination, double detourBudget) {
+    const CompactGraph<int>& graph = getSnapshot();
+    if (detourBudget < 0) {
+        throw std::runtime_error("Error: Corridor parking needs a MaxTime\n");
+    }
+    int destIndex = graph.findIndex(destination);
+    if (destIndex == -1) {
+        throw std::runtime_error("Error: Vertex with id " + std::to_string(destination) + " not found!\n");
+    }
+
+    std::vector<Edge<int>*> roads = cityGraph.dijkstraDriving(source, destination);
+    std::ofstream file("../output.txt");
+    std::cout << "Source:" << source << "\n";
+    std::cout << "Destination:" << destination << "\n";
+    file << "Source:" << source << "\n";
+    file << "Destination:" << destination << "\n";
+    if (roads.empty() && source != destination) {
+        std::cout << "DrivingRoute:none\n";
+        file << "DrivingRoute:none\n";
+        file.close();
+        return;
+    }
+
+    // route vertices and how far along the route each one is
+    std::vector<int> route{graph.findIndex(source)};
+    std::vector<double> along(graph.getNumVertex(), 0);
+    double driveTime = 0;
+    std::cout << "DrivingRoute:" << source;
+    file << "DrivingRoute:" << source;
+    for (Edge<int>* road : roads) {
+        driveTime += road->getDriveTime();
+        int v = graph.findIndex(road->getDest()->getInfo());
+        route.push_back(v);
+        along[v] = driveTime;
+        std::cout << "," << road->getDest()->getInfo();
+        file << "," << road->getDest()->getInfo();
+    }
+    std::cout << "(" << driveTime << ")\n";
+    file << "(" << driveTime << ")\n";
+
+    SearchWorkspace drive, walk;
+    for (const CorridorParking& parking : corridorParking(graph, route, destIndex, detourBudget, drive, walk)) {
+        double arrival = along[parking.exit] + parking.detour + parking.walk;
+        std::cout << "ParkingNode:" << graph.getInfo(parking.vertex) << " Exit:" << graph.getInfo(parking.exit)
+                  << " Detour:" << parking.detour << " Walk:" << parking.walk << " Arrival:" << arrival << "\n";
+        file << "ParkingNode:" << graph.getInfo(parking.vertex) << " Exit:" << graph.getInfo(parking.exit)
+             << " Detour:" << parking.detour << " Walk:" << parking.walk << " Arrival:" << arrival << "\n";
+    }
+    file.close();
+}
+
+/*
+ * Dispatches idle vehicles (Sources, one id per vehicle) to pickup requests (Destinations),
+ * minimising the total driving time to the pickups. Pairs further apart than maxPickupTime
+ * are never matched; leaving a request unserved costs more than any set of feasible pickups,
+ * so as many requests as possible are served.
+ */
+void StorageHandler::calculateFleetAssignment(const std::vector<int>& vehicles, const std::vector<int>& requests,
+                                              double maxPickupTime) {
+    const CompactGraph<int>& graph = getSnapshot();
+    if (maxPickupTime < 0) {
+        throw std::runtime_error("Error: Fleet assignment needs a MaxTime\n");
+    }
+    std::vector<int> vehicleIndexes, requestIndexes;
+    for (int id : vehicles) {
+        int index = graph.findIndex(id);
+        if (index == -1) {
+            throw std::runtime_error("Error: Vertex with id " + std::to_string(id) + " not found!\n");
+        }
+        vehicleIndexes.push_back(index);
+    }
+    for (int id : requests) {
+        int index = graph.findIndex(id);
+        if (index == -1) {
+            throw std::runtime_error("Error: Vertex with id " + std::to_string(id) + " not found!\n");
+        }
+        requestIndexes.push_back(index);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    FleetDispatcher<int> dispatcher(graph);
+    FleetAssignment result = dispatcher.assign(vehicleIndexes, requestIndexes, maxPickupTime,
+                                               maxPickupTime * (requests.size() + 1));
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::ofstream file("../output.txt");
+    for (size_t r = 0; r < requests.size(); r++) {
+        if (result.vehicle[r] == -1) {
+            std::cout << "Request:" << requests[r] << " Unserved\n";
+            file << "Request:" << requests[r] << " Unserved\n";
+        } else {
+            std::cout << "Request:" << requests[r] << " Vehicle:" << result.vehicle[r] + 1 << "(" << vehicles[result.vehicle[r]] << ")"
+                      << " Time:" << result.time[r] << "\n";
+            file << "Request:" << requests[r] << " Vehicle:" << result.vehicle[r] + 1 << "(" << vehicles[result.vehicle[r]] << ")"
+                 << " Time:" << result.time[r] << "\n";
+        }
+    }
+    std::cout << "Served:" << result.served << "/" << requests.size() << " TotalTime:" << result.totalTime << "\n";
+    file << "Served:" << result.served << "/" << requests.size() << " TotalTime:" << result.totalTime << "\n";
+    std::cout << "FeasiblePairs:" << result.feasiblePairs << " Time:" << ms << "ms\n";
+    file << "FeasiblePairs:" << result.feasiblePairs << " Time:" << ms << "ms\n";
+    file.close();
+}
+
+/*
+ * Assigns the trips of a demand file to the roads at user equilibrium, with the road
+ * capacities as BPR capacities, and stores the congested driving times as the "congested"
+ * profile, which later queries can route with.
+ */
+void StorageHandler::calculateTrafficAssignment(const std::string& demandFile, int iterations) {
+    const CompactGraph<int>& graph = getSnapshot();
+    int capacity = graph.findProfile(CAPACITY_COLUMN);
+    if (capacity == -1) {
+        throw std::runtime_error("Error: No road capacities loaded!\n");
+    }
+    std::vector<Demand> demand = loadDemand(demandFile);
+
+    TrafficAssignment<int> assignment(graph, graph.getWeights(DRIVING), graph.getWeights(capacity));
+    AssignmentResult result = assignment.assign(demand, iterations);
+
+    std::map<std::pair<int, int>, double>& congested = profileWeights[CONGESTED_PROFILE];
+    congested.clear();
+    for (int e = 0; e < graph.getNumEdges(); e++) {
+        congested[{graph.getInfo(graph.getTail(e)), graph.getInfo(graph.getHead(e))}] = result.times[e];
+    }
+    // edges whose congested time changed since the last assignment, with the old time
+    std::vector<std::pair<int, double>> changes;
+    int previous = graph.findProfile(CONGESTED_PROFILE);
+    if (previous != -1) {
+        const std::vector<double>& old = graph.getWeights(previous);
+        for (int e = 0; e < graph.getNumEdges(); e++) {
+            if (old[e] != result.times[e]) changes.push_back({e, old[e]});
+        }
+    }
+    int congestedProfile = snapshot->addWeightColumn(CONGESTED_PROFILE, result.times);
+    geometricBounds.erase(congestedProfile);
+    if (arcFlags.count(congestedProfile)) arcFlags[congestedProfile]->edgesChanged(changes); // only the regions that need it
+    transitNodes.erase(congestedProfile);
+    reachBounds.erase(congestedProfile);
+    distanceOracles.erase(congestedProfile);
+    poiIndex.reset(); // its candidate lists may be kept for the congested profile
+    for (size_t h = 0; h < routeSessions.size(); h++) {
+        // sessions copy their weights, a fresh query would no longer match them
+        if (routeSessionProfiles[h] == congestedProfile) routeSessions[h].reset();
+    }
+    if (overlayMetrics.count(congestedProfile)) overlayMetrics[congestedProfile]->customize(); // same partition, new metric
+
+    std::vector<int> loaded;
+    for (int e = 0; e < graph.getNumEdges(); e++) {
+        if (result.flow[e] > 0) loaded.push_back(e);
+    }
+    std::stable_sort(loaded.begin(), loaded.end(), [&](int a, int b) { return result.flow[a] > result.flow[b]; });
+
+    std::ofstream file("../output.txt");
+    std::cout << "Iterations:" << result.iterations << "\n";
+    file << "Iterations:" << result.iterations << "\n";
+    std::cout << "RelativeGap:" << result.relativeGap << "\n";
+    file << "RelativeGap:" << result.relativeGap << "\n";
+    std::cout << "TotalTime:" << result.totalTime << "\n";
+    file << "TotalTime:" << result.totalTime << "\n";
+    std::cout << "Unassigned:" << result.unassigned << "\n";
+    file << "Unassigned:" << result.unassigned << "\n";
+    for (int e : loaded) {
+        std::cout << "Segment:" << graph.getInfo(graph.getTail(e)) << "," << graph.getInfo(graph.getHead(e)) << "(" << result.flow[e] << ")"
+                  << " Time:" << result.times[e] << "\n";
+        file << "Segment:" << graph.getInfo(graph.getTail(e)) << "," << graph.getInfo(graph.getHead(e)) << "(" << result.flow[e] << ")"
+             << " Time:" << result.times[e] << "\n";
+    }
+    file.close();
+}
+
+/*
+ * Ranks the closure of each segment (both directions) by the delay it causes to the
+ * driving trips of a demand file; trips left without any route are counted apart.
+ */
+void StorageHandler::calculateClosureImpact(const std::string& demandFile, const std::vector<std::pair<int, int>>& closures) {
+    const CompactGraph<int>& graph = getSnapshot();
+    std::vector<Demand> demand = loadDemand(demandFile);
+
+    std::vector<std::vector<int>> closedEdges;
+    for (const auto& [a, b] : closures) {
+        int u = graph.findIndex(a), v = graph.findIndex(b);
+        if (u == -1 || v == -1) {
+            throw std::runtime_error("Error: Vertex with id " + std::to_string(u == -1 ? a : b) + " not found!\n");
+        }
+        std::vector<int> edges;
+        for (int e = graph.edgesBegin(u); e < graph.edgesEnd(u); e++) {
+            if (graph.getHead(e) == v) edges.push_back(e);
+        }
+        for (int e = graph.edgesBegin(v); e < graph.edgesEnd(v); e++) {
+            if (graph.getHead(e) == u) edges.push_back(e);
+        }
+        if (edges.empty()) {
+            throw std::runtime_error("Error: No road between " + std::to_string(a) + " and " + std::to_string(b) + "\n");
+        }
+        closedEdges.push_back(edges);
+    }
+
+    std::vector<ClosureImpact> impacts = analyseClosures(graph, demand, closedEdges);
+
+    std::ofstream file("../output.txt");
+    for (const ClosureImpact& impact : impacts) {
+        const auto& [a, b] = closures[impact.closure];
+        std::cout << "Closure:" << a << "," << b << "(" << impact.delay << ")"
+                  << " Affected:" << impact.affected << " Disconnected:" << impact.disconnected << "\n";
+        file << "Closure:" << a << "," << b << "(" << impact.delay << ")"
+             << " Affected:" << impact.affected << " Disconnected:" << impact.disconnected << "\n";
+    }
+    file.close();
+}
+
+/*
+ * Offline placement of count new parking facilities for the driving + walking trips listed
+ * in an "Origin,Destination[,Trips]" demand file (codes or ids). Candidates default to every
+ * location without parking.
+ */
+void StorageHandler::calculateParkingPlacement(const std::string& demandFile, int count, int maxWalkingTime,
+                                               const std::vector<int>& candidates) {
+    if (maxWalkingTime < 0) {
+        throw std::runtime_error("Error: Parking placement needs a MaxWalkTime\n");
+    }
+
+    const CompactGraph<int>& graph = getSnapshot();
+    std::vector<Demand> demand = loadDemand(demandFile);
+
+    std::vector<int> existing = getPoiIndex().getVertices(PARKING_CATEGORY);
+    std::vector<int> candidateIndexes;
+    if (candidates.empty()) {
+        for (int v = 0; v < graph.getNumVertex(); v++) {
+            if (!graph.hasParking(v)) candidateIndexes.push_back(v);
+        }
+    }
+    for (int id : candidates) {
+        int index = graph.findIndex(id);
+        if (index == -1) {
+            throw std::runtime_error("Error: Vertex with id " + std::to_string(id) + " not found!\n");
+        }
+        candidateIndexes.push_back(index);
+    }
+
+    ParkingPlacement<int> placement(graph, demand, existing, candidateIndexes, maxWalkingTime, UNSERVED_TRIP_COST);
+    PlacementResult result = placement.place(count);
+
+    std::ofstream file("../output.txt");
+    std::cout << "InitialTime:" << result.initialCost << "\n";
+    file << "InitialTime:" << result.initialCost << "\n";
+    for (size_t i = 0; i < result.steps.size(); i++) {
+        std::cout << "Parking" << i + 1 << ":" << graph.getInfo(result.steps[i].vertex) << "(-" << result.steps[i].gain << ")\n";
+        file << "Parking" << i + 1 << ":" << graph.getInfo(result.steps[i].vertex) << "(-" << result.steps[i].gain << ")\n";
+    }
+    std::cout << "FinalTime:" << result.finalCost << "\n";
+    file << "FinalTime:" << result.finalCost << "\n";
+    file.close();
+}
+
+/*
+ * Vertex where the travellers starting at sources (each with its own profile) should meet
+ * to minimise the sum ("sum") or the maximum ("max") of their travel times.
+ */
+void StorageHandler::calculateMeetingPoint(const std::vector<int>& sources, const std::vector<std::string>& profiles,
+                                           const std::string& objective) {
+    if (objective != "sum" && objective != "max") {
+        throw std::runtime_error("Error: Unknown objective " + objective + "\n");
+    }
+    if (sources.size() != profiles.size()) {
+        throw std::runtime_error("Error: Expected one profile per source\n");
+    }
+
+    const CompactGraph<int>& graph = getSnapshot();
+    std::vector<Participant> participants;
+    for (size_t i = 0; i < sources.size(); i++) {
+        int index = graph.findIndex(sources[i]);
+        if (index == -1) {
+            throw std::runtime_error("Error: Vertex with id " + std::to_string(sources[i]) + " not found!\n");
+        }
+        participants.push_back({index, parseProfile(profiles[i])});
+    }
+
+    MeetingPointEngine<int> engine(graph);
+    MeetingPoint meeting = engine.find(participants, objective == "sum" ? MEETING_SUM : MEETING_MAX);
+
+    std::ofstream file("../output.txt");
+    if (meeting.vertex == -1) {
+        std::cout << "MeetingPoint:none\n";
+        file << "MeetingPoint:none\n";
+        file.close();
+        return;
+    }
+    std::cout << "MeetingPoint:" << graph.getInfo(meeting.vertex) << "\n";
+    file << "MeetingPoint:" << graph.getInfo(meeting.vertex) << "\n";
+    std::cout << "Cost:" << meeting.cost << "\n";
+    file << "Cost:" << meeting.cost << "\n";
+    std::cout << "Times:";
+    file << "Times:";
+    for (size_t i = 0; i < sources.size(); i++) {
+        std::cout << (i ? "," : "") << sources[i] << "(" << meeting.times[i] << ")";
+        file << (i ? "," : "") << sources[i] << "(" << meeting.times[i] << ")";
+    }
+    std::cout << "\n";
+    file << "\n";
+    file.close();
+}
+
+/*
+ * Earliest arrival walking and riding public transit, leaving at departureTime
+ * (minutes after midnight). Each leg is printed as a line.
+ */
+void StorageHandler::calculateTransitRoute(int source, int destination, double departureTime) {
+    if (departureTime < 0) {
+        throw std::runtime_error("Error: Transit routes need a DepartureTime\n");
+    }
+    TransitRouter<int>& router = getTransitRouter();
+    const CompactGraph<int>& graph = getSnapshot();
+    int sourceIndex = graph.findIndex(source);
+    int destIndex = graph.findIndex(destination);
+    if (sourceIndex == -1 || destIndex == -1) {
+        throw std::runtime_error("Error: Vertex with id " + std::to_string(sourceIndex == -1 ? source : destination) + " not found!\n");
+    }
+
+    TransitJourney journey = router.earliestArrival(sourceIndex, destIndex, departureTime);
+
+    std::ofstream file("../output.txt");
+    auto clock = [](double minutes) {
+        int total = static_cast<int>(std::ceil(minutes * 60 - 1e-6)); // seconds, rounded up
+        char buffer[16];
+        snprintf(buffer, sizeof(buffer), "%02d:%02d:%02d", total / 3600, total / 60 % 60, total % 60);
+        return std::string(buffer);
+    };
+    auto place = [&](int stop, int vertex) {
+        return stop == -1 ? std::to_string(graph.getInfo(vertex)) : "stop " + timetable->getStopId(stop);
+    };
+
+    std::cout << "Source:" << source << "\n";
+    std::cout << "Destination:" << destination << "\n";
+    file << "Source:" << source << "\n";
+    file << "Destination:" << destination << "\n";
+    if (journey.arrival == INF) {
+        std::cout << "Journey:none\n";
+        file << "Journey:none\n";
+        file.close();
+        return;
+    }
+
+    for (const TransitLeg& leg : journey.legs) {
+        std::string line = leg.walking ? "Walk:" : "Ride:" + timetable->getRouteName(leg.route) + ",";
+        line += place(leg.fromStop, sourceIndex) + "(" + clock(leg.departure) + ")," +
+                place(leg.toStop, destIndex) + "(" + clock(leg.arrival) + ")";
+        std::cout << line << "\n";
+        file << line << "\n";
+    }
+    std::cout << "Arrival:" << clock(journey.arrival) << "\n";
+    file << "Arrival:" << clock(journey.arrival) << "\n";
+    file.close();
+}
+
+/*
+ * Times the sequential Dijkstra tree against the parallel delta-stepping engine
+ * for the same source and checks that both produce the same distances.
+ */
+void StorageHandler::benchmarkShortestPathTree(int source, const std::string& profile, double delta) {
+    std::ofstream file("../output.txt");
+    const CompactGraph<int>& graph = getSnapshot();
+    int sourceIndex = graph.findIndex(source);
+    if (sourceIndex == -1) {
+        throw std::runtime_error("Error: Vertex with id " + std::to_string(source) + " not found!\n");
+    }
+    const std::vector<double>& weights = graph.getWeights(parseProfile(profile));
+
+    SearchWorkspace ws(graph.getNumVertex());
+    auto start = std::chrono::steady_clock::now();
+    shortestPathTree(graph, weights, sourceIndex, ws);
+    double sequentialMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    DeltaStepping<int> engine(graph, parseProfile(profile), delta);
+    start = std::chrono::steady_clock::now();
+    engine.run(sourceIndex);
+    double parallelMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // equal-cost paths summed in another order may differ in the last bits
+    const std::vector<double>& parallelDist = engine.getDistances();
+    bool match = true;
+    for (size_t v = 0; v < parallelDist.size() && match; v++) {
+        double a = ws.dist[v], b = parallelDist[v];
+        match = a == b || (a != INF && b != INF && std::abs(a - b) <= 1e-9 * std::max(a, b));
+    }
+
+    std::cout << "Source:" << source << "\n";
+    std::cout << "Dijkstra:" << sequentialMs << "ms\n";
+    std::cout << "DeltaStepping:" << parallelMs << "ms (delta=" << engine.getDelta() << ", threads=" << getThreadCount() << ")\n";
+    std::cout << "Match:" << (match ? "yes" : "no") << "\n";
+    file << "Source:" << source << "\n";
+    file << "Dijkstra:" << sequentialMs << "ms\n";
+    file << "DeltaStepping:" << parallelMs << "ms (delta=" << engine.getDelta() << ", threads=" << getThreadCount() << ")\n";
+    file << "Match:" << (match ? "yes" : "no") << "\n";
+    file.close();
+}
+
 std::vector<int> StorageHandler::parseCommaSeparatedIntegers(const std::string& str) {
     std::vector<int> result;
     std::stringstream ss(str);
@@ -410,6 +1952,18 @@ std::vector<int> StorageHandler::parseCommaSeparatedIntegers(const std::string&
     return result;
 }
 
+std::vector<std::pair<double, double>> StorageHandler::parsePositions(const std::string& str) {
+    std::vector<std::pair<double, double>> result;
+    std::regex position_regex(R"(\(\s*(-?[\d.]+)\s*,\s*(-?[\d.]+)\s*\))");
+    auto positions_begin = std::sregex_iterator(str.begin(), str.end(), position_regex);
+    auto positions_end = std::sregex_iterator();
+
+    for (auto it = positions_begin; it != positions_end; ++it) {
+        result.push_back({std::stod((*it)[1].str()), std::stod((*it)[2].str())});
+    }
+    return result;
+}
+
 std::vector<std::pair<int, int>> StorageHandler::parsePairs(const std::string& str) {
     std::vector<std::pair<int, int>> result;
     std::regex segment_regex(R"(\((\d+),(\d+)\))");
@@ -435,6 +1989,25 @@ int StorageHandler::parseBatchInput(Data* data) {
     data->avoidSegments.clear();
     data->includeNode = -1;
     data->maxWalkTime = -1;
+    data->sources.clear();
+    data->destinations.clear();
+    data->profile = "driving";
+    data->delta = 0;
+    data->maxTime = -1;
+    data->category = "";
+    data->k = 1;
+    data->sourcePosition.reset();
+    data->destinationPosition.reset();
+    data->positions.clear();
+    data->traceFile = "";
+    data->departureTime = -1;
+    data->profiles.clear();
+    data->objective = "sum";
+    data->demandFile = "";
+    data->samples = 0;
+    data->iterations = 50;
+    data->handle = -1;
+    data->stretch = 1.5;
 
     if (!inputFile.is_open()) {
         throw std::runtime_error("File input.txt not found in project root.");
@@ -463,6 +2036,45 @@ int StorageHandler::parseBatchInput(Data* data) {
                     data->includeNode = std::stoi(value);
                 } else if (key == "MaxWalkTime") {
                     data->maxWalkTime = std::stoi(value);
+                } else if (key == "Sources") {
+                    data->sources = parseCommaSeparatedIntegers(value);
+                } else if (key == "Destinations") {
+                    data->destinations = parseCommaSeparatedIntegers(value);
+                } else if (key == "Profile") {
+                    data->profile = value;
+                } else if (key == "Delta") {
+                    data->delta = std::stod(value);
+                } else if (key == "MaxTime") {
+                    data->maxTime = std::stod(value);
+                } else if (key == "Category") {
+                    data->category = value;
+                } else if (key == "K") {
+                    data->k = std::stoi(value);
+                } else if (key == "SourcePosition" || key == "DestinationPosition") {
+                    std::vector<std::pair<double, double>> position = parsePositions("(" + value + ")");
+                    if (position.size() != 1) return -1;
+                    if (key == "SourcePosition") data->sourcePosition = position[0];
+                    else data->destinationPosition = position[0];
+                } else if (key == "Positions") {
+                    data->positions = parsePositions(value);
+                } else if (key == "TraceFile") {
+                    data->traceFile = value;
+                } else if (key == "Profiles") {
+                    data->profiles = splitFields(value, ',');
+                } else if (key == "Objective") {
+                    data->objective = value;
+                } else if (key == "DemandFile") {
+                    data->demandFile = value;
+                } else if (key == "Samples") {
+                    data->samples = std::stoi(value);
+                } else if (key == "Iterations") {
+                    data->iterations = std::stoi(value);
+                } else if (key == "Handle") {
+                    data->handle = std::stoi(value);
+                } else if (key == "Stretch") {
+                    data->stretch = std::stod(value);
+                } else if (key == "DepartureTime") {
+                    data->departureTime = gtfs::parseTime(value.find(':') == value.rfind(':') ? value + ":00" : value);
                 } else {
                     return -1; // ignore badly formatted input
                 }
@@ -477,7 +2089,12 @@ int StorageHandler::parseBatchInput(Data* data) {
     return 0;
 }
 
-void StorageHandler::callBatchFunction(const Data& data) {
+void StorageHandler::callBatchFunction(const Data& input) {
+    // GPS positions given instead of ids are snapped to their nearest location
+    Data data = input;
+    if (data.sourcePosition.has_value()) data.source = snapToVertex(data.sourcePosition.value());
+    if (data.destinationPosition.has_value()) data.destination = snapToVertex(data.destinationPosition.value());
+
     if (data.mode == "driving") {
         if (data.avoidNodes.empty() && data.avoidSegments.empty() && data.includeNode == -1) {
             cityGraph.fastestDrivingPathWithAlt(data.source, data.destination);
@@ -487,5 +2104,59 @@ void StorageHandler::callBatchFunction(const Data& data) {
         }
     } else if (data.mode == "driving-walking") {
         calculateEnvironmentalRoute(data.source, data.destination, data.maxWalkTime, data.avoidNodes, data.avoidSegments);
+    } else if (data.mode == "distance-table") {
+        calculateDistanceTable(data.sources, data.profile);
+    } else if (data.mode == "route") {
+        calculateRoute(data.source, data.destination, data.profile);
+    } else if (data.mode == "bidirectional" || data.mode == "bidirectional-parallel") {
+        calculateBidirectionalRoute(data.source, data.destination, data.profile, data.mode == "bidirectional-parallel");
+    } else if (data.mode == "isochrone-driving" || data.mode == "isochrone-walking" || data.mode == "isochrone-driving-walking") {
+        std::vector<int> origins = data.sources;
+        if (origins.empty()) origins.push_back(data.source);
+        calculateIsochrones(origins, data.maxTime, data.mode);
+    } else if (data.mode == "nearest-poi") {
+        calculateNearestPoi(data.source, data.category, data.k, data.profile);
+    } else if (data.mode == "snap") {
+        snapPositions(data.positions);
+    } else if (data.mode == "map-matching") {
+        matchTraces(data.traceFile);
+    } else if (data.mode == "driving-turns") {
+        calculateTurnRoute(data.source, data.destination);
+    } else if (data.mode == "transit-nodes") {
+        calculateTransitNodeDistance(data.source, data.destination, data.profile);
+    } else if (data.mode == "overlay") {
+        calculateOverlayRoute(data.source, data.destination, data.profile);
+    } else if (data.mode == "distance-oracle") {
+        calculateOracleEstimates(data.sources, data.destinations, data.profile, data.stretch);
+    } else if (data.mode == "reach") {
+        calculateReachRoute(data.source, data.destination, data.profile);
+    } else if (data.mode == "arc-flags") {
+        calculateArcFlagsRoute(data.source, data.destination, data.profile);
+    } else if (data.mode == "route-session") {
+        startRouteSession(data.source, data.destination, data.profile);
+    } else if (data.mode == "reroute") {
+        reroute(data.handle, data.source, data.avoidSegments);
+    } else if (data.mode == "corridor-parking") {
+        calculateCorridorParking(data.source, data.destination, data.maxTime);
+    } else if (data.mode == "fleet-assignment") {
+        calculateFleetAssignment(data.sources, data.destinations, data.maxTime);
+    } else if (data.mode == "traffic-assignment") {
+        calculateTrafficAssignment(data.demandFile, data.iterations);
+    } else if (data.mode == "closure-impact") {
+        calculateClosureImpact(data.demandFile, data.avoidSegments);
+    } else if (data.mode == "max-flow") {
+        calculateMaxFlow(data.sources, data.destinations);
+    } else if (data.mode == "betweenness") {
+        calculateBetweenness(data.profile, data.samples);
+    } else if (data.mode == "parking-placement") {
+        calculateParkingPlacement(data.demandFile, data.k, data.maxWalkTime, data.sources);
+    } else if (data.mode == "meeting-point") {
+        std::vector<std::string> profiles = data.profiles;
+        if (profiles.empty()) profiles.assign(data.sources.size(), data.profile);
+        calculateMeetingPoint(data.sources, profiles, data.objective);
+    } else if (data.mode == "walking-transit") {
+        calculateTransitRoute(data.source, data.destination, data.departureTime);
+    } else if (data.mode == "tree-benchmark") {
+        benchmarkShortestPathTree(data.source, data.profile, data.delta);
     }
 }
\ No newline at end of file
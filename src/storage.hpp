@@ -1,8 +1,47 @@
 #ifndef STORAGE_HPP
 #define STORAGE_HPP
 
+#include <map>
+#include <memory>
 #include <string>
+#include <tuple>
 #include "graph.hpp"
+#include "compactgraph.hpp"
+#include "poi.hpp"
+#include "spatial.hpp"
+#include "geometric.hpp"
+#include "transit.hpp"
+#include "turns.hpp"
+#include "meetingpoint.hpp"
+#include "placement.hpp"
+#include "closure.hpp"
+#include "rerouting.hpp"
+#include "arcflags.hpp"
+#include "overlay.hpp"
+#include "transitnodes.hpp"
+#include "reach.hpp"
+#include "oracle.hpp"
+
+// POIs per vertex kept in the precomputed candidate lists
+const int POI_CANDIDATES = 8;
+// travel time charged to a demand trip that no parking within walking distance can serve
+const double UNSERVED_TRIP_COST = 240;
+// farthest a transit stop is linked to its nearest vertex, meters; stops beyond stay unlinked
+const double MAX_STOP_SNAP_DISTANCE = 300;
+// regions of the partition the arc flags are computed over
+const int ARC_FLAG_REGIONS = 32;
+// levels of the multi-level overlay, and the vertices its finest cells aim for
+const int OVERLAY_LEVELS = 3;
+const int OVERLAY_CELL_SIZE = 128;
+// vertices per cell of the transit node partition, whose boundary vertices are the candidate
+// transit nodes, and the most transit nodes kept (the table is their count squared floats)
+const int TRANSIT_NODE_CELL_SIZE = 1024;
+const int TRANSIT_NODE_LIMIT = 4096;
+// vertices a search settles before reaching the reach threshold; larger prunes more, builds slower
+const int REACH_BALL = 1024;
+// landmarks of the distance oracle, saved as <profile>.oracle in the data directory
+const int ORACLE_LANDMARKS = 16;
+const std::string ORACLE_DIRECTORY = "../data/";
 
 struct Data {
     std::string mode;
@@ -12,24 +51,107 @@ struct Data {
     std::vector<std::pair<int,int>> avoidSegments;
     int includeNode = -1;
     int maxWalkTime = -1;
+    std::vector<int> sources;
+    std::vector<int> destinations;
+    std::string profile = "driving";
+    double delta = 0;
+    double maxTime = -1;
+    std::string category;
+    int k = 1;
+    std::optional<std::pair<double,double>> sourcePosition; // latitude, longitude
+    std::optional<std::pair<double,double>> destinationPosition;
+    std::vector<std::pair<double,double>> positions;
+    std::string traceFile;
+    double departureTime = -1; // minutes after midnight
+    std::vector<std::string> profiles; // one per source, Profile is used when empty
+    std::string objective = "sum";
+    std::string demandFile;
+    int samples = 0; // 0 = exact
+    int iterations = 50;
+    int handle = -1; // route session to re-route
+    double stretch = 1.5; // distance oracle estimates stay within stretch times the real distance
 };
 
 class StorageHandler {
 public:
     void loadLocations(const std::string& locationsFile);
     void loadRoads(const std::string& roadFile);
+    void loadPointsOfInterest(const std::string& poiFile);
+    void loadTransitFeed(const std::string& gtfsDirectory);
+    void loadTurns(const std::string& turnsFile);
+    void loadProfiles(const std::string& profilesFile);
 
     void callDijkstra(const std::string& source, const std::string& dest);
     void callRestrictedDijkstra(const std::string& src, const std::string& dest, 
         const std::string& avoidNodes, const std::string& avoidSegments, const std::string& includeNode);
     void calculateEnvironmentalRoute(int source, int destination, int maxWalkingTime, std::vector<int> avoidNodes, std::vector<std::pair<int,int>> avoidSegments);
+    void calculateDistanceTable(const std::vector<int>& sources, const std::string& profile);
+    void calculateRoute(int source, int destination, const std::string& profile);
+    void calculateBidirectionalRoute(int source, int destination, const std::string& profile, bool parallel);
+    void calculateIsochrones(const std::vector<int>& origins, double maxTime, const std::string& mode);
+    void calculateNearestPoi(int source, const std::string& category, int k, const std::string& profile);
+    void snapPositions(const std::vector<std::pair<double, double>>& positions);
+    void matchTraces(const std::string& traceFile);
+    void calculateTransitRoute(int source, int destination, double departureTime);
+    void calculateTurnRoute(int source, int destination);
+    void calculateMaxFlow(const std::vector<int>& sources, const std::vector<int>& sinks);
+    void calculateBetweenness(const std::string& profile, int samples);
+    void calculateOracleEstimates(const std::vector<int>& sources, const std::vector<int>& destinations,
+                                  const std::string& profile, double stretch);
+    void calculateReachRoute(int source, int destination, const std::string& profile);
+    void calculateTransitNodeDistance(int source, int destination, const std::string& profile);
+    void calculateOverlayRoute(int source, int destination, const std::string& profile);
+    void calculateArcFlagsRoute(int source, int destination, const std::string& profile);
+    void startRouteSession(int source, int destination, const std::string& profile);
+    void reroute(int handle, int current, const std::vector<std::pair<int, int>>& closures);
+    void calculateCorridorParking(int source, int destination, double detourBudget);
+    void calculateFleetAssignment(const std::vector<int>& vehicles, const std::vector<int>& requests, double maxPickupTime);
+    void calculateTrafficAssignment(const std::string& demandFile, int iterations);
+    void calculateClosureImpact(const std::string& demandFile, const std::vector<std::pair<int, int>>& closures);
+    void calculateParkingPlacement(const std::string& demandFile, int count, int maxWalkingTime, const std::vector<int>& candidates);
+    void calculateMeetingPoint(const std::vector<int>& sources, const std::vector<std::string>& profiles, const std::string& objective);
+    void benchmarkShortestPathTree(int source, const std::string& profile, double delta);
     int parseBatchInput(Data* data);
     void callBatchFunction(const Data& data);
 
 private:
     Graph<int> cityGraph;
+    std::unique_ptr<CompactGraph<int>> snapshot; // rebuilt lazily after the graph is (re)loaded
+    std::map<std::string, std::map<std::pair<int, int>, double>> profileWeights; // named profile -> (from, to) ids -> weight
+    std::unique_ptr<PoiIndex<int>> poiIndex;
+    std::unique_ptr<SpatialIndex<int>> spatialIndex;
+    std::map<int, std::unique_ptr<GeometricBound<int>>> geometricBounds; // per profile
+    std::map<int, std::unique_ptr<ArcFlags<int>>> arcFlags; // per profile
+    std::unique_ptr<OverlayGraph<int>> overlayGraph;
+    std::map<int, std::unique_ptr<OverlayMetric<int>>> overlayMetrics; // per profile
+    std::map<int, std::unique_ptr<TransitNodeRouting<int>>> transitNodes; // per profile
+    std::map<int, std::unique_ptr<ReachBounds<int>>> reachBounds; // per profile
+    std::map<int, std::unique_ptr<DistanceOracle<int>>> distanceOracles; // per profile
+    std::unique_ptr<TransitTimetable> timetable;
+    std::unique_ptr<TransitRouter<int>> transitRouter; // links the timetable to the snapshot
+    std::vector<std::tuple<int, int, int, double>> turnRules; // from, via, to ids and cost
+    std::unique_ptr<TurnTable<int>> turnTable;
+    std::vector<std::unique_ptr<RouteSession<int>>> routeSessions; // indexed by handle, null once ended
+    std::vector<int> routeSessionProfiles; // profile each session routes on
+    const CompactGraph<int>& getSnapshot();
+    PoiIndex<int>& getPoiIndex();
+    void invalidateSnapshot();
+    const SpatialIndex<int>& getSpatialIndex();
+    const GeometricBound<int>& getGeometricBound(int profile);
+    ArcFlags<int>& getArcFlags(int profile);
+    OverlayMetric<int>& getOverlayMetric(int profile);
+    TransitNodeRouting<int>& getTransitNodes(int profile);
+    const ReachBounds<int>& getReachBounds(int profile);
+    DistanceOracle<int>& getDistanceOracle(int profile);
+    TransitRouter<int>& getTransitRouter();
+    const TurnTable<int>& getTurnTable();
+    int snapToVertex(const std::pair<double, double>& position);
+    int parseProfile(const std::string& profile);
+    void setProfileWeight(const std::string& profile, const std::string& loc1, const std::string& loc2, const std::string& weight);
     std::vector<int> parseCommaSeparatedIntegers(const std::string& str);
     std::vector<std::pair<int, int>> parsePairs(const std::string& str);
+    std::vector<std::pair<double, double>> parsePositions(const std::string& str);
+    std::vector<Demand> loadDemand(const std::string& demandFile);
 };
 
 #endif
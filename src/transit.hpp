@@ -0,0 +1,509 @@
+#ifndef TRANSIT_HPP
+#define TRANSIT_HPP
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "compactgraph.hpp"
+#include "parallel.hpp"
+#include "search.hpp"
+#include "spatial.hpp"
+
+/******************** TransitTimetable ********************/
+
+/*
+ * A day's public transit timetable loaded from a local GTFS feed (stops.txt and
+ * stop_times.txt), in the flat array layout RAPTOR scans:
+ *  - trips with the same stop sequence are grouped into one route (split further when
+ *    a trip would overtake another, so the trips of a route keep their order at every stop);
+ *  - routeStops[routeStopsBegin[r] + i] is the i-th stop of route r;
+ *  - the trips of a route are sorted by departure and their times are stored row by row
+ *    in stopTimes[stopTimesBegin[r] + trip * stops + i];
+ *  - stopRoutes lists, for every stop, the routes serving it and the stop's position in them.
+ * Times are minutes after midnight (GTFS times past 24:00 are kept as such).
+ */
+class TransitTimetable {
+public:
+    struct StopTime {
+        double arrival;
+        double departure;
+    };
+
+    void load(const std::string& gtfsDirectory);
+
+    int getNumStops() const;
+    int getNumRoutes() const;
+    const std::string& getStopId(int stop) const;
+    double getStopLatitude(int stop) const;
+    double getStopLongitude(int stop) const;
+
+    int getRouteSize(int route) const; // stops per trip
+    int getNumTrips(int route) const;
+    int getRouteStop(int route, int position) const;
+    const StopTime& getStopTime(int route, int trip, int position) const;
+    const std::string& getRouteName(int route) const;
+
+    // (route, position) pairs of the routes serving a stop
+    const std::vector<std::pair<int, int>>& getStopRoutes(int stop) const;
+
+protected:
+    std::vector<std::string> stopIds;
+    std::vector<double> stopLatitudes, stopLongitudes;
+    std::vector<std::string> routeNames; // GTFS route_id of the first trip grouped in the route
+
+    std::vector<int> routeStopsBegin; // routes + 1 entries
+    std::vector<int> routeStops;
+    std::vector<int> tripCounts;
+    std::vector<int> stopTimesBegin;
+    std::vector<StopTime> stopTimes;
+    std::vector<std::vector<std::pair<int, int>>> stopRoutes;
+};
+
+/******************** TransitRouter ********************/
+
+// one leg of a walk + transit journey
+struct TransitLeg {
+    bool walking;
+    int fromStop, toStop;  // -1 for the origin / destination vertex
+    int route;             // -1 for walking legs
+    double departure, arrival;
+};
+
+struct TransitJourney {
+    double arrival = INF;
+    std::vector<TransitLeg> legs;
+};
+
+/*
+ * Walk + transit earliest-arrival queries over a TransitTimetable linked to the road graph.
+ * Every stop is attached to its nearest vertex within maxSnapDistance meters. Stops farther
+ * from the road graph are left unlinked, as the walk to them cannot be timed. Footpaths
+ * between stops are walking searches over the graph bounded by maxTransferWalk, computed
+ * in parallel at construction.
+ * Queries walk from the origin to the stops within maxAccessWalk, run RAPTOR rounds
+ * (one per extra trip, at most maxTrips) and walk from the stops to the destination.
+ * Walking the whole way is also considered when it takes less than maxAccessWalk.
+ * One router per thread, since queries reuse its workspaces.
+ */
+template <class T>
+class TransitRouter {
+public:
+    TransitRouter(const CompactGraph<T>& graph, const SpatialIndex<T>& index, const TransitTimetable& timetable,
+                  double maxSnapDistance = INF, double maxTransferWalk = 10, double maxAccessWalk = 20, int maxTrips = 5);
+
+    TransitJourney earliestArrival(int origin, int destination, double departure);
+
+protected:
+    // how a stop was reached in a round; kind -1 means the arrival was carried over
+    struct Label {
+        int kind = -1;     // 0 access walk, 1 trip, 2 footpath
+        int from = -1;     // boarding stop (trip) or previous stop (footpath)
+        int route = -1, trip = -1, boardPosition = -1;
+        double departure = INF; // start of the footpath
+    };
+
+    const CompactGraph<T>& graph;
+    const TransitTimetable& timetable;
+    double maxAccessWalk;
+    int maxTrips;
+
+    std::vector<int> stopVertex; // -1 when unlinked
+    std::vector<std::vector<std::pair<int, double>>> footpaths; // per stop: (stop, minutes)
+    std::unordered_map<int, std::vector<int>> vertexStops;
+
+    SearchWorkspace accessWs, egressWs;
+};
+
+/************************* TransitTimetable  **************************/
+
+namespace gtfs {
+
+// splits a GTFS csv line, honouring double quotes
+inline std::vector<std::string> splitLine(const std::string& line) {
+    std::vector<std::string> fields(1);
+    bool quoted = false;
+    for (char c : line) {
+        if (c == '"') quoted = !quoted;
+        else if (c == ',' && !quoted) fields.emplace_back();
+        else if (c != '\r' && c != '\n') fields.back() += c;
+    }
+    return fields;
+}
+
+inline int column(const std::vector<std::string>& header, const std::string& name) {
+    for (size_t i = 0; i < header.size(); i++) {
+        // the first header may start with a UTF-8 byte order mark
+        if (header[i] == name || (i == 0 && header[i].size() >= 3 && header[i].substr(3) == name)) return i;
+    }
+    throw std::runtime_error("GTFS error: missing column " + name + "\n");
+}
+
+// HH:MM:SS to minutes after midnight
+inline double parseTime(const std::string& str) {
+    int h = 0, m = 0, s = 0;
+    char sep;
+    std::stringstream ss(str);
+    ss >> h >> sep >> m >> sep >> s;
+    if (ss.fail()) throw std::invalid_argument("bad time " + str);
+    return h * 60 + m + s / 60.0;
+}
+
+} // namespace gtfs
+
+inline void TransitTimetable::load(const std::string& gtfsDirectory) {
+    std::ifstream stopsFile(gtfsDirectory + "/stops.txt");
+    if (!stopsFile.is_open()) {
+        throw std::runtime_error("Could not open " + gtfsDirectory + "/stops.txt");
+    }
+    std::string line;
+    getline(stopsFile, line);
+    std::vector<std::string> header = gtfs::splitLine(line);
+    int idCol = gtfs::column(header, "stop_id"), latCol = gtfs::column(header, "stop_lat"), lonCol = gtfs::column(header, "stop_lon");
+
+    std::unordered_map<std::string, int> stopIndex;
+    while (getline(stopsFile, line)) {
+        std::vector<std::string> fields = gtfs::splitLine(line);
+        if (static_cast<int>(fields.size()) <= std::max({idCol, latCol, lonCol}) || fields[idCol].empty()) continue;
+        try {
+            double lat = std::stod(fields[latCol]), lon = std::stod(fields[lonCol]);
+            stopIndex[fields[idCol]] = stopIds.size();
+            stopIds.push_back(fields[idCol]);
+            stopLatitudes.push_back(lat);
+            stopLongitudes.push_back(lon);
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Warning: Skipping stop with invalid position: " << line << "\n";
+        }
+    }
+    stopsFile.close();
+
+    std::ifstream tripsFile(gtfsDirectory + "/trips.txt");
+    std::unordered_map<std::string, std::string> tripRoute;
+    if (tripsFile.is_open()) {
+        getline(tripsFile, line);
+        header = gtfs::splitLine(line);
+        int tripCol = gtfs::column(header, "trip_id"), routeCol = gtfs::column(header, "route_id");
+        while (getline(tripsFile, line)) {
+            std::vector<std::string> fields = gtfs::splitLine(line);
+            if (static_cast<int>(fields.size()) > std::max(tripCol, routeCol)) tripRoute[fields[tripCol]] = fields[routeCol];
+        }
+        tripsFile.close();
+    }
+
+    std::ifstream timesFile(gtfsDirectory + "/stop_times.txt");
+    if (!timesFile.is_open()) {
+        throw std::runtime_error("Could not open " + gtfsDirectory + "/stop_times.txt");
+    }
+    getline(timesFile, line);
+    header = gtfs::splitLine(line);
+    int tripCol = gtfs::column(header, "trip_id"), arrCol = gtfs::column(header, "arrival_time"),
+        depCol = gtfs::column(header, "departure_time"), stopCol = gtfs::column(header, "stop_id"),
+        seqCol = gtfs::column(header, "stop_sequence");
+
+    // trip -> (sequence, stop, times)
+    std::map<std::string, std::vector<std::tuple<int, int, StopTime>>> trips;
+    while (getline(timesFile, line)) {
+        std::vector<std::string> fields = gtfs::splitLine(line);
+        if (static_cast<int>(fields.size()) <= std::max({tripCol, arrCol, depCol, stopCol, seqCol})) continue;
+        auto stop = stopIndex.find(fields[stopCol]);
+        if (stop == stopIndex.end()) continue;
+        try {
+            double arrival = gtfs::parseTime(fields[arrCol].empty() ? fields[depCol] : fields[arrCol]);
+            double departure = gtfs::parseTime(fields[depCol].empty() ? fields[arrCol] : fields[depCol]);
+            trips[fields[tripCol]].push_back({std::stoi(fields[seqCol]), stop->second, {arrival, departure}});
+        } catch (const std::invalid_argument& e) {
+            continue; // untimed stops (interpolated in the feed) are skipped
+        }
+    }
+    timesFile.close();
+
+    // group trips by stop sequence
+    std::map<std::vector<int>, std::vector<std::pair<std::vector<StopTime>, std::string>>> routes; // trip times and route_id
+    for (auto& [tripId, stops] : trips) {
+        if (stops.size() < 2) continue;
+        std::sort(stops.begin(), stops.end(), [](const auto& a, const auto& b) { return std::get<0>(a) < std::get<0>(b); });
+        std::vector<int> sequence;
+        std::vector<StopTime> times;
+        for (const auto& entry : stops) {
+            sequence.push_back(std::get<1>(entry));
+            times.push_back(std::get<2>(entry));
+        }
+        auto name = tripRoute.find(tripId);
+        routes[sequence].push_back({times, name != tripRoute.end() ? name->second : tripId});
+    }
+
+    stopRoutes.assign(stopIds.size(), {});
+    routeStopsBegin.assign(1, 0);
+    for (auto& [sequence, sequenceTrips] : routes) {
+        std::sort(sequenceTrips.begin(), sequenceTrips.end(), [](const auto& a, const auto& b) {
+            return a.first[0].departure < b.first[0].departure;
+        });
+
+        // RAPTOR needs trips that never overtake each other: a trip that would overtake
+        // the last one of every group so far starts a new route with the same stops
+        std::vector<std::vector<int>> groups;
+        for (size_t t = 0; t < sequenceTrips.size(); t++) {
+            bool placed = false;
+            for (auto& group : groups) {
+                const std::vector<StopTime>& last = sequenceTrips[group.back()].first;
+                bool overtakes = false;
+                for (size_t i = 0; i < sequence.size() && !overtakes; i++) {
+                    overtakes = sequenceTrips[t].first[i].departure < last[i].departure ||
+                                sequenceTrips[t].first[i].arrival < last[i].arrival;
+                }
+                if (!overtakes) {
+                    group.push_back(t);
+                    placed = true;
+                    break;
+                }
+            }
+            if (!placed) groups.push_back({static_cast<int>(t)});
+        }
+
+        for (const auto& group : groups) {
+            int route = routeNames.size();
+            routeNames.push_back(sequenceTrips[group[0]].second);
+            for (size_t i = 0; i < sequence.size(); i++) stopRoutes[sequence[i]].push_back({route, static_cast<int>(i)});
+            routeStops.insert(routeStops.end(), sequence.begin(), sequence.end());
+            routeStopsBegin.push_back(routeStops.size());
+            tripCounts.push_back(group.size());
+            stopTimesBegin.push_back(stopTimes.size());
+            for (int t : group) stopTimes.insert(stopTimes.end(), sequenceTrips[t].first.begin(), sequenceTrips[t].first.end());
+        }
+    }
+}
+
+inline int TransitTimetable::getNumStops() const {
+    return stopIds.size();
+}
+
+inline int TransitTimetable::getNumRoutes() const {
+    return tripCounts.size();
+}
+
+inline const std::string& TransitTimetable::getStopId(int stop) const {
+    return stopIds[stop];
+}
+
+inline double TransitTimetable::getStopLatitude(int stop) const {
+    return stopLatitudes[stop];
+}
+
+inline double TransitTimetable::getStopLongitude(int stop) const {
+    return stopLongitudes[stop];
+}
+
+inline int TransitTimetable::getRouteSize(int route) const {
+    return routeStopsBegin[route + 1] - routeStopsBegin[route];
+}
+
+inline int TransitTimetable::getNumTrips(int route) const {
+    return tripCounts[route];
+}
+
+inline int TransitTimetable::getRouteStop(int route, int position) const {
+    return routeStops[routeStopsBegin[route] + position];
+}
+
+inline const TransitTimetable::StopTime& TransitTimetable::getStopTime(int route, int trip, int position) const {
+    return stopTimes[stopTimesBegin[route] + trip * getRouteSize(route) + position];
+}
+
+inline const std::string& TransitTimetable::getRouteName(int route) const {
+    return routeNames[route];
+}
+
+inline const std::vector<std::pair<int, int>>& TransitTimetable::getStopRoutes(int stop) const {
+    return stopRoutes[stop];
+}
+
+/************************* TransitRouter  **************************/
+
+template <class T>
+TransitRouter<T>::TransitRouter(const CompactGraph<T>& graph, const SpatialIndex<T>& index, const TransitTimetable& timetable,
+                                double maxSnapDistance, double maxTransferWalk, double maxAccessWalk, int maxTrips)
+    : graph(graph), timetable(timetable), maxAccessWalk(maxAccessWalk), maxTrips(maxTrips) {
+    int stops = timetable.getNumStops();
+    stopVertex.assign(stops, -1);
+    int unlinked = 0;
+    for (int s = 0; s < stops; s++) {
+        double lat = timetable.getStopLatitude(s), lon = timetable.getStopLongitude(s);
+        int v = index.nearestVertex(lat, lon);
+        if (v == -1 || haversineDistance(lat, lon, graph.getLatitude(v), graph.getLongitude(v)) > maxSnapDistance) {
+            unlinked++;
+            continue;
+        }
+        stopVertex[s] = v;
+        vertexStops[v].push_back(s);
+    }
+    if (unlinked > 0) {
+        std::cerr << "Warning: Skipping " << unlinked << " stops farther than " << maxSnapDistance
+                  << "m from the road network\n";
+    }
+
+    footpaths.assign(stops, {});
+    unsigned int threads = getThreadCount();
+    std::vector<SearchWorkspace> ws(threads);
+    parallelFor(stops, [&](int s, unsigned int t) {
+        if (stopVertex[s] == -1) return;
+        shortestPathTree(graph, graph.getWeights(WALKING), stopVertex[s], ws[t], maxTransferWalk);
+        for (int v : ws[t].order) {
+            auto it = vertexStops.find(v);
+            if (it == vertexStops.end()) continue;
+            for (int other : it->second) {
+                if (other != s) footpaths[s].push_back({other, ws[t].dist[v]});
+            }
+        }
+    }, threads);
+}
+
+template <class T>
+TransitJourney TransitRouter<T>::earliestArrival(int origin, int destination, double departure) {
+    const std::vector<double>& walking = graph.getWeights(WALKING);
+    int stops = timetable.getNumStops();
+    TransitJourney journey;
+
+    shortestPathTree(graph, walking, origin, accessWs, maxAccessWalk);
+    shortestPathTree(graph, walking, destination, egressWs, maxAccessWalk, true);
+    // only settled labels are walks within the limit; the search leaves larger tentative ones behind
+    auto egress = [&](int s) {
+        return stopVertex[s] != -1 && egressWs.settled[stopVertex[s]] ? egressWs.dist[stopVertex[s]] : INF;
+    };
+
+    if (egressWs.settled[origin]) {
+        journey.arrival = departure + egressWs.dist[origin];
+        journey.legs = {{true, -1, -1, -1, departure, journey.arrival}};
+    }
+
+    // arrival[k][s]: earliest arrival at s with at most k trips
+    std::vector<std::vector<double>> arrival(maxTrips + 1, std::vector<double>(stops, INF));
+    std::vector<std::vector<Label>> labels(maxTrips + 1, std::vector<Label>(stops));
+    std::vector<double> best(stops, INF);
+    std::vector<char> marked(stops, false);
+
+    for (int s = 0; s < stops; s++) {
+        if (stopVertex[s] == -1 || !accessWs.settled[stopVertex[s]]) continue;
+        double walk = accessWs.dist[stopVertex[s]];
+        arrival[0][s] = best[s] = departure + walk;
+        labels[0][s].kind = 0;
+        marked[s] = true;
+    }
+
+    double target = journey.arrival; // best arrival at the destination so far, prunes the rounds
+    int bestRound = -1, bestStop = -1;
+
+    for (int k = 1; k <= maxTrips; k++) {
+        // routes serving a stop improved last round, each scanned from its earliest such stop
+        std::map<int, int> queue;
+        for (int s = 0; s < stops; s++) {
+            if (!marked[s]) continue;
+            for (const auto& [route, position] : timetable.getStopRoutes(s)) {
+                auto it = queue.find(route);
+                if (it == queue.end() || position < it->second) queue[route] = position;
+            }
+            marked[s] = false;
+        }
+        if (queue.empty()) break;
+        arrival[k] = arrival[k - 1];
+
+        for (const auto& [route, first] : queue) {
+            int size = timetable.getRouteSize(route);
+            int trips = timetable.getNumTrips(route);
+            int trip = -1, boardStop = -1, boardPosition = -1;
+            for (int i = first; i < size; i++) {
+                int s = timetable.getRouteStop(route, i);
+                if (trip != -1) {
+                    double arr = timetable.getStopTime(route, trip, i).arrival;
+                    if (arr < std::min(best[s], target)) {
+                        arrival[k][s] = best[s] = arr;
+                        labels[k][s] = {1, boardStop, route, trip, boardPosition, INF};
+                        marked[s] = true;
+                    }
+                }
+
+                // board an earlier trip if this stop was reached in time for it
+                double ready = arrival[k - 1][s];
+                if (ready == INF) continue;
+                int limit = trip == -1 ? trips : trip;
+                int low = 0, high = limit; // first trip of [0, limit) leaving at or after 'ready'
+                while (low < high) {
+                    int mid = (low + high) / 2;
+                    if (timetable.getStopTime(route, mid, i).departure < ready) low = mid + 1;
+                    else high = mid;
+                }
+                if (low < limit) {
+                    trip = low;
+                    boardStop = s;
+                    boardPosition = i;
+                }
+            }
+        }
+
+        // footpaths from the stops reached by a trip in this round
+        std::vector<int> improved;
+        for (int s = 0; s < stops; s++) {
+            if (marked[s]) improved.push_back(s);
+        }
+        for (int s : improved) {
+            for (const auto& [other, walk] : footpaths[s]) {
+                double arr = arrival[k][s] + walk;
+                if (arr < std::min(best[other], target)) {
+                    arrival[k][other] = best[other] = arr;
+                    labels[k][other] = {2, s, -1, -1, -1, arrival[k][s]};
+                    marked[other] = true;
+                }
+            }
+        }
+
+        for (int s = 0; s < stops; s++) {
+            if (!marked[s] || egress(s) == INF) continue;
+            if (arrival[k][s] + egress(s) < target) {
+                target = arrival[k][s] + egress(s);
+                bestRound = k;
+                bestStop = s;
+            }
+        }
+    }
+
+    if (bestRound == -1) return journey;
+
+    // rebuild the legs backwards from the stop where the final walk starts
+    std::vector<TransitLeg> legs;
+    legs.push_back({true, bestStop, -1, -1, arrival[bestRound][bestStop], target});
+    int k = bestRound, s = bestStop;
+    while (true) {
+        while (labels[k][s].kind == -1) k--;
+        const Label& label = labels[k][s];
+        if (label.kind == 0) {
+            legs.push_back({true, -1, s, -1, departure, arrival[0][s]});
+            break;
+        }
+        if (label.kind == 2) {
+            legs.push_back({true, label.from, s, -1, label.departure, arrival[k][s]});
+            s = label.from; // reached by a trip of the same round
+            continue;
+        }
+        legs.push_back({false, label.from, s, label.route,
+                        timetable.getStopTime(label.route, label.trip, label.boardPosition).departure,
+                        timetable.getStopTime(label.route, label.trip, timetable.getRouteSize(label.route) - 1).arrival});
+        for (int i = label.boardPosition; i < timetable.getRouteSize(label.route); i++) {
+            if (timetable.getRouteStop(label.route, i) == s) {
+                legs.back().arrival = timetable.getStopTime(label.route, label.trip, i).arrival;
+                break;
+            }
+        }
+        s = label.from;
+        k--;
+    }
+
+    std::reverse(legs.begin(), legs.end());
+    journey.arrival = target;
+    journey.legs = legs;
+    return journey;
+}
+
+#endif
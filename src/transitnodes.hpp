@@ -0,0 +1,280 @@
+#ifndef TRANSITNODES_HPP
+#define TRANSITNODES_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "compactgraph.hpp"
+#include "parallel.hpp"
+#include "partition.hpp"
+#include "search.hpp"
+
+/******************** TransitNodeRouting ********************/
+
+/*
+ * Transit Node Routing on one weight column, for distance queries between far-apart vertices.
+ *
+ * The graph is split into cells by the built-in partitioner. A shortest path from s to t in
+ * another cell leaves the cell of s at the tail a of its first outgoing edge, with s..a inside
+ * the cell, and enters the cell of t at the head b of its last incoming edge, with b..t inside.
+ * So d(s, t) = min over such boundary vertices a, b of d(s, a) + d(a, b) + d(b, t).
+ *
+ * The access nodes of v are the boundary vertices of its cell with their distance from v
+ * (forward) or to v (backward) inside the cell, found by searches restricted to each cell. An
+ * access node a is dropped when another one a' closer to v has d(v, a') + d(a', a) <= d(v, a),
+ * because any path through a is then no shorter than the one through a'. The in-cell distance
+ * between the two stands in for d(a', a), being no shorter.
+ *
+ * The transit nodes are the boundary vertices found in the most access lists, at most maxTransit
+ * of them, since the cut of a partition into cells of fixed size grows with the graph. The transit
+ * table holds d(a, b) for every pair, one full search per transit node, as floats rounded up. The
+ * access lists are then pruned again against the table.
+ *
+ * Queries within one cell, where the path need not leave it, and queries with an access node
+ * left out of the table go to a plain search. Every other query is |access(s)| * |access(t)|
+ * table lookups.
+ */
+template <class T>
+class TransitNodeRouting {
+public:
+    TransitNodeRouting(const CompactGraph<T>& graph, const std::vector<double>& weights, int cells, int maxTransit);
+
+    int getTransitCount() const;
+    bool isLocal(int source, int target) const; // answered by a plain search
+    // distance, INF if unreachable; table queries may exceed it by the float rounding of the
+    // table. ws is only used by local queries
+    double distance(int source, int target, SearchWorkspace& ws);
+    int getLookups() const; // table entries read by the last query, 0 if it was local
+
+protected:
+    typedef std::vector<std::pair<int, double>> AccessList; // (node, distance), closest first
+
+    const CompactGraph<T>& graph;
+    const std::vector<double>& weights;
+    std::vector<int> cell;
+    std::vector<int> transit;  // transit nodes
+    std::vector<float> table;  // flat, row = from
+    // access nodes of every vertex, as (transit index, distance), in [begin[v], begin[v + 1])
+    std::vector<int> forwardBegin, backwardBegin;
+    std::vector<std::pair<int, double>> forwardAccess, backwardAccess;
+    std::vector<char> forwardCovered, backwardCovered; // every access node has a transit index
+    int lookups = 0;
+
+    void cellTree(int source, bool backward, SearchWorkspace& ws) const;
+    void cellAccess(const std::vector<int>& members, const std::vector<int>& boundary, const std::vector<int>& position,
+                    SearchWorkspace& ws, std::vector<AccessList>& forward, std::vector<AccessList>& backward) const;
+    // drops the entries of a sorted list dominated by a closer one; via(a, b) bounds d(a, b)
+    template <class D>
+    static void prune(AccessList& list, bool backward, D via);
+    void flatten(std::vector<AccessList>& lists, const std::vector<int>& transitIndex, bool backward,
+                 std::vector<int>& begin, std::vector<std::pair<int, double>>& access, std::vector<char>& covered);
+};
+
+/************************* TransitNodeRouting  **************************/
+
+template <class T>
+TransitNodeRouting<T>::TransitNodeRouting(const CompactGraph<T>& graph, const std::vector<double>& weights,
+                                          int cells, int maxTransit)
+    : graph(graph), weights(weights), cell(partitionGraph(graph, cells)) {
+    int n = graph.getNumVertex();
+    std::vector<char> isBoundary(n, false);
+    for (int e = 0; e < graph.getNumEdges(); e++) {
+        int u = graph.getTail(e), v = graph.getHead(e);
+        if (cell[u] != cell[v]) isBoundary[u] = isBoundary[v] = true;
+    }
+    std::vector<std::vector<int>> membersOf(cells), boundaryOf(cells);
+    std::vector<int> position(n, -1); // of a boundary vertex in the list of its cell
+    for (int v = 0; v < n; v++) {
+        membersOf[cell[v]].push_back(v);
+        if (!isBoundary[v]) continue;
+        position[v] = boundaryOf[cell[v]].size();
+        boundaryOf[cell[v]].push_back(v);
+    }
+
+    // access lists by vertex, naming boundary vertices; cells own disjoint vertices
+    std::vector<AccessList> forward(n), backward(n);
+    unsigned int threads = getThreadCount();
+    std::vector<SearchWorkspace> ws(threads);
+    parallelFor(cells, [&](int c, unsigned int t) {
+        cellAccess(membersOf[c], boundaryOf[c], position, ws[t], forward, backward);
+    }, threads);
+
+    std::vector<int> uses(n, 0);
+    for (int v = 0; v < n; v++) {
+        for (const auto& [a, d] : forward[v]) uses[a]++;
+        for (const auto& [b, d] : backward[v]) uses[b]++;
+    }
+    for (int v = 0; v < n; v++) {
+        if (isBoundary[v]) transit.push_back(v);
+    }
+    if (static_cast<int>(transit.size()) > maxTransit) {
+        std::stable_sort(transit.begin(), transit.end(), [&](int a, int b) { return uses[a] > uses[b]; });
+        transit.resize(std::max(0, maxTransit));
+        std::sort(transit.begin(), transit.end());
+    }
+    std::vector<int> transitIndex(n, -1);
+    for (size_t i = 0; i < transit.size(); i++) transitIndex[transit[i]] = i;
+
+    size_t count = transit.size();
+    table.assign(count * count, std::numeric_limits<float>::infinity());
+    parallelFor(count, [&](int i, unsigned int t) {
+        shortestPathTree(graph, weights, transit[i], ws[t]);
+        for (size_t j = 0; j < count; j++) {
+            double d = ws[t].dist[transit[j]];
+            if (d == INF) continue;
+            float f = static_cast<float>(d);
+            table[i * count + j] = f < d ? std::nextafter(f, std::numeric_limits<float>::infinity()) : f;
+        }
+    }, threads);
+
+    flatten(forward, transitIndex, false, forwardBegin, forwardAccess, forwardCovered);
+    flatten(backward, transitIndex, true, backwardBegin, backwardAccess, backwardCovered);
+}
+
+template <class T>
+int TransitNodeRouting<T>::getTransitCount() const {
+    return transit.size();
+}
+
+template <class T>
+bool TransitNodeRouting<T>::isLocal(int source, int target) const {
+    return cell[source] == cell[target] || !forwardCovered[source] || !backwardCovered[target];
+}
+
+template <class T>
+int TransitNodeRouting<T>::getLookups() const {
+    return lookups;
+}
+
+template <class T>
+void TransitNodeRouting<T>::cellTree(int source, bool backward, SearchWorkspace& ws) const {
+    ws.resize(graph.getNumVertex());
+    ws.reset();
+    int own = cell[source];
+
+    SearchQueue pq;
+    ws.reach(source, 0, -1);
+    pq.push({0, source});
+    while (!pq.empty()) {
+        auto [d, u] = pq.top();
+        pq.pop();
+        if (ws.settled[u] || d > ws.dist[u]) continue;
+        ws.settled[u] = true;
+        ws.order.push_back(u);
+        auto relax = [&](int e, int v) {
+            if (weights[e] == INF || cell[v] != own || ws.settled[v]) return;
+            if (d + weights[e] < ws.dist[v]) {
+                ws.reach(v, d + weights[e], e);
+                pq.push({d + weights[e], v});
+            }
+        };
+        if (backward) {
+            for (int i = graph.inEdgesBegin(u); i < graph.inEdgesEnd(u); i++) relax(graph.getInEdge(i), graph.getTail(graph.getInEdge(i)));
+        } else {
+            for (int e = graph.edgesBegin(u); e < graph.edgesEnd(u); e++) relax(e, graph.getHead(e));
+        }
+    }
+}
+
+/*
+ * Access lists of the vertices of one cell, pruned with the in-cell distances between its
+ * boundary vertices.
+ */
+template <class T>
+void TransitNodeRouting<T>::cellAccess(const std::vector<int>& members, const std::vector<int>& boundary,
+                                       const std::vector<int>& position, SearchWorkspace& ws,
+                                       std::vector<AccessList>& forward, std::vector<AccessList>& backward) const {
+    size_t size = boundary.size();
+    std::vector<double> inner(size * size, INF); // in-cell d(boundary[i], boundary[j])
+
+    // forward access nodes of v are found by backward searches from them, and the other way round
+    for (size_t i = 0; i < size; i++) {
+        cellTree(boundary[i], false, ws);
+        for (int v : ws.order) backward[v].push_back({boundary[i], ws.dist[v]});
+        for (size_t j = 0; j < size; j++) {
+            if (ws.settled[boundary[j]]) inner[i * size + j] = ws.dist[boundary[j]];
+        }
+
+        cellTree(boundary[i], true, ws);
+        for (int v : ws.order) forward[v].push_back({boundary[i], ws.dist[v]});
+    }
+
+    auto via = [&](int a, int b) { return inner[position[a] * size + position[b]]; };
+    for (int v : members) {
+        prune(forward[v], false, via);
+        prune(backward[v], true, via);
+    }
+}
+
+template <class T>
+template <class D>
+void TransitNodeRouting<T>::prune(AccessList& list, bool backward, D via) {
+    std::sort(list.begin(), list.end(), [](const std::pair<int, double>& a, const std::pair<int, double>& b) {
+        return a.second < b.second || (a.second == b.second && a.first < b.first);
+    });
+    size_t kept = 0;
+    for (size_t k = 0; k < list.size(); k++) {
+        const auto& [a, d] = list[k];
+        bool dominated = false;
+        for (size_t j = 0; j < kept && !dominated; j++) {
+            int closer = list[j].first;
+            dominated = list[j].second + (backward ? via(a, closer) : via(closer, a)) <= d;
+        }
+        if (!dominated) list[kept++] = list[k];
+    }
+    list.resize(kept);
+}
+
+/*
+ * Flat access arrays in transit indices. A vertex with an access node outside the table is left
+ * uncovered, without entries; the others are pruned once more against the table.
+ */
+template <class T>
+void TransitNodeRouting<T>::flatten(std::vector<AccessList>& lists, const std::vector<int>& transitIndex, bool backward,
+                                    std::vector<int>& begin, std::vector<std::pair<int, double>>& access,
+                                    std::vector<char>& covered) {
+    int n = graph.getNumVertex();
+    size_t count = transit.size();
+    auto via = [&](int a, int b) {
+        float d = table[a * count + b];
+        return d == std::numeric_limits<float>::infinity() ? INF : static_cast<double>(d);
+    };
+    begin.assign(n + 1, 0);
+    covered.assign(n, true);
+    access.clear();
+    for (int v = 0; v < n; v++) {
+        AccessList& list = lists[v];
+        for (auto& entry : list) {
+            entry.first = transitIndex[entry.first];
+            if (entry.first == -1) covered[v] = false;
+        }
+        if (covered[v]) {
+            prune(list, backward, via);
+            access.insert(access.end(), list.begin(), list.end());
+        }
+        begin[v + 1] = access.size();
+        AccessList().swap(list);
+    }
+}
+
+template <class T>
+double TransitNodeRouting<T>::distance(int source, int target, SearchWorkspace& ws) {
+    lookups = 0;
+    if (isLocal(source, target)) return shortestPath(graph, weights, source, target, ws);
+
+    size_t count = transit.size();
+    double best = INF;
+    for (int i = forwardBegin[source]; i < forwardBegin[source + 1]; i++) {
+        const float* row = &table[forwardAccess[i].first * count];
+        for (int j = backwardBegin[target]; j < backwardBegin[target + 1]; j++) {
+            // an unreachable pair is an infinite float, which never becomes the minimum
+            best = std::min(best, forwardAccess[i].second + row[backwardAccess[j].first] + backwardAccess[j].second);
+        }
+        lookups += backwardBegin[target + 1] - backwardBegin[target];
+    }
+    return best;
+}
+
+#endif
@@ -0,0 +1,199 @@
+#ifndef TURNS_HPP
+#define TURNS_HPP
+
+#include <algorithm>
+#include <vector>
+#include "compactgraph.hpp"
+#include "search.hpp"
+
+// a turn from edge (from -> via) into edge (via -> to); vertex indices of the snapshot
+struct TurnEntry {
+    int from, via, to;
+    double cost; // INF bans the turn
+};
+
+/******************** TurnTable ********************/
+
+/*
+ * Turn costs and banned turns at intersections, as one small matrix per vertex:
+ * row = position of the incoming edge among the vertex's incoming edges,
+ * column = position of the outgoing edge among its outgoing edges.
+ * Only vertices with at least one listed turn get a matrix; every other turn costs
+ * uTurnCost if it goes straight back along the reverse edge, and nothing otherwise.
+ */
+template <class T>
+class TurnTable {
+public:
+    TurnTable(const CompactGraph<T>& graph, const std::vector<TurnEntry>& turns, double uTurnCost = 0);
+
+    // cost of leaving inEdge's head through outEdge
+    double cost(int inEdge, int outEdge) const;
+    // true when every turn at v is free, so the edge v is entered through does not matter
+    bool isFree(int v) const;
+    // number of turns that could not be matched to a pair of edges
+    int getSkipped() const;
+
+protected:
+    const CompactGraph<T>& graph;
+    double uTurnCost;
+    std::vector<int> matrixBegin; // per vertex, -1 when no matrix
+    std::vector<double> costs;
+    std::vector<int> inRank;      // per edge: position among the incoming edges of its head
+    std::vector<int> reverseEdge; // per edge: the opposite direction, -1 if none
+    int skipped = 0;
+};
+
+/*
+ * Edge-based point-to-point A* (Dijkstra with a zero heuristic) honouring a TurnTable,
+ * without building the line graph. A state is the edge a vertex was entered through, but
+ * only where that matters: vertices where every turn is free get one state for the vertex
+ * itself (workspace entry edges + v), so away from listed turns the search does the work of
+ * a node-based one. dist[e] is the time at the head of e and parent[e] the edge driven
+ * before it, for every edge relaxed; parent[edges + v] is the edge v was entered through.
+ * heuristic(v) must be a consistent lower bound on the time from v to the target.
+ * Returns the distance (INF if unreachable) and sets lastEdge to the edge arriving at the
+ * target (-1 if source == target or unreachable); the route is read with extractTurnPath.
+ */
+template <class T, class H>
+double shortestTurnPath(const CompactGraph<T>& graph, const std::vector<double>& weights, const TurnTable<T>& turns,
+                        int source, int target, SearchWorkspace& ws, int& lastEdge, H heuristic) {
+    int m = graph.getNumEdges();
+    ws.resize(m + graph.getNumVertex());
+    ws.reset();
+    lastEdge = -1;
+    if (source == target) return 0;
+
+    SearchQueue pq; // keyed on distance + heuristic
+    auto relax = [&](int f, double d, int previous) {
+        int w = graph.getHead(f);
+        int state = turns.isFree(w) ? m + w : f;
+        if (d >= ws.dist[state]) return;
+        ws.reach(f, d, previous);
+        if (state != f) ws.reach(state, d, f);
+        pq.push({d + heuristic(w), state});
+    };
+    auto expand = [&](int v, double d, int arrival) {
+        for (int f = graph.edgesBegin(v); f < graph.edgesEnd(v); f++) {
+            double w = weights[f];
+            if (w == INF) continue;
+            double turn = arrival == -1 ? 0 : turns.cost(arrival, f);
+            if (turn == INF) continue;
+            relax(f, d + turn + w, arrival);
+        }
+    };
+
+    if (turns.isFree(source)) {
+        ws.reach(m + source, 0, -1);
+        pq.push({heuristic(source), m + source});
+    } else {
+        expand(source, 0, -1);
+    }
+
+    while (!pq.empty()) {
+        int state = pq.top().second;
+        pq.pop();
+        if (ws.settled[state]) continue;
+        ws.settled[state] = true;
+        ws.order.push_back(state);
+        double d = ws.dist[state];
+        int arrival = state >= m ? ws.parent[state] : state;
+        int v = state >= m ? state - m : graph.getHead(state);
+        if (v == target) {
+            lastEdge = arrival;
+            return d;
+        }
+        expand(v, d, arrival);
+    }
+    return INF;
+}
+
+/*
+ * Edge-based Dijkstra, see above.
+ */
+template <class T>
+double shortestTurnPath(const CompactGraph<T>& graph, const std::vector<double>& weights, const TurnTable<T>& turns,
+                        int source, int target, SearchWorkspace& ws, int& lastEdge) {
+    return shortestTurnPath(graph, weights, turns, source, target, ws, lastEdge, [](int) { return 0.0; });
+}
+
+/*
+ * Edge ids of the route found by shortestTurnPath, in travel order.
+ */
+inline std::vector<int> extractTurnPath(const SearchWorkspace& ws, int lastEdge) {
+    std::vector<int> path;
+    for (int e = lastEdge; e != -1; e = ws.parent[e]) path.push_back(e);
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+/************************* TurnTable  **************************/
+
+template <class T>
+TurnTable<T>::TurnTable(const CompactGraph<T>& graph, const std::vector<TurnEntry>& turns, double uTurnCost)
+    : graph(graph), uTurnCost(uTurnCost) {
+    int n = graph.getNumVertex(), m = graph.getNumEdges();
+    inRank.assign(m, 0);
+    for (int v = 0; v < n; v++) {
+        for (int i = graph.inEdgesBegin(v); i < graph.inEdgesEnd(v); i++) inRank[graph.getInEdge(i)] = i - graph.inEdgesBegin(v);
+    }
+
+    reverseEdge.assign(m, -1);
+    for (int e = 0; e < m; e++) {
+        Edge<T>* reverse = graph.getEdge(e)->getReverse();
+        if (reverse == nullptr) continue;
+        int v = graph.getHead(e);
+        for (int r = graph.edgesBegin(v); r < graph.edgesEnd(v); r++) {
+            if (graph.getEdge(r) == reverse) reverseEdge[e] = r;
+        }
+    }
+
+    matrixBegin.assign(n, -1);
+    for (const TurnEntry& turn : turns) {
+        int v = turn.via;
+        if (matrixBegin[v] != -1) continue;
+        matrixBegin[v] = costs.size();
+        // default costs: free, except going back along the reverse edge
+        for (int i = graph.inEdgesBegin(v); i < graph.inEdgesEnd(v); i++) {
+            for (int f = graph.edgesBegin(v); f < graph.edgesEnd(v); f++) {
+                costs.push_back(reverseEdge[graph.getInEdge(i)] == f ? uTurnCost : 0);
+            }
+        }
+    }
+
+    for (const TurnEntry& turn : turns) {
+        int v = turn.via, inEdge = -1, outEdge = -1;
+        for (int i = graph.inEdgesBegin(v); i < graph.inEdgesEnd(v); i++) {
+            if (graph.getTail(graph.getInEdge(i)) == turn.from) inEdge = graph.getInEdge(i);
+        }
+        for (int f = graph.edgesBegin(v); f < graph.edgesEnd(v); f++) {
+            if (graph.getHead(f) == turn.to) outEdge = f;
+        }
+        if (inEdge == -1 || outEdge == -1) {
+            skipped++;
+            continue;
+        }
+        int out = graph.edgesEnd(v) - graph.edgesBegin(v);
+        costs[matrixBegin[v] + inRank[inEdge] * out + (outEdge - graph.edgesBegin(v))] = turn.cost;
+    }
+}
+
+template <class T>
+double TurnTable<T>::cost(int inEdge, int outEdge) const {
+    int v = graph.getHead(inEdge);
+    int begin = matrixBegin[v];
+    if (begin == -1) return reverseEdge[inEdge] == outEdge ? uTurnCost : 0;
+    int out = graph.edgesEnd(v) - graph.edgesBegin(v);
+    return costs[begin + inRank[inEdge] * out + (outEdge - graph.edgesBegin(v))];
+}
+
+template <class T>
+bool TurnTable<T>::isFree(int v) const {
+    return matrixBegin[v] == -1 && uTurnCost == 0;
+}
+
+template <class T>
+int TurnTable<T>::getSkipped() const {
+    return skipped;
+}
+
+#endif